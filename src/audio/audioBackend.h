@@ -0,0 +1,96 @@
+#ifndef GRAPHICS_AUDIOBACKEND_H
+#define GRAPHICS_AUDIOBACKEND_H
+
+#include <atomic>
+
+#include "../synth/realtimeThread.h"
+#include "../synth/synth.h"
+#include "callbackStats.h"
+#include "latencyConfig.h"
+
+/**
+ * @brief Something that pulls buffers from a Synth and plays or stores them.
+ * @details A backend owns the thread that calls Synth::render() and the clock that note events
+ * are stamped with. The engine talks to every backend the same way, so the synth and its
+ * callback path run unchanged on a sound card, on a timer with no hardware, or into a file.
+ */
+class AudioBackend {
+public:
+    /// @brief The number of frames rendered per buffer unless a backend negotiates something else.
+    static constexpr unsigned long DEFAULT_FRAMES_PER_BUFFER = 64;
+
+    virtual ~AudioBackend() = default;
+
+    /// @brief Acquires the output (device, file, ...).
+    /// @return false if the output is not available
+    virtual bool open() = 0;
+
+    /// @brief Starts rendering. The synth is pulled from another thread from then on.
+    /// @return true if rendering started
+    virtual bool start() = 0;
+
+    /// @brief Stops rendering.
+    /// @return true if rendering was running and stopped
+    virtual bool stop() = 0;
+
+    /// @brief Stops rendering if needed and releases the output.
+    /// @return true if the output was open and closed cleanly
+    virtual bool close() = 0;
+
+    /// @brief The current time on the clock note events should be stamped with, in seconds.
+    virtual double time() const = 0;
+
+    /// @brief A short name for log messages.
+    virtual const char *getName() const = 0;
+
+    /// @brief How long the render callbacks take and how often the output has glitched.
+    /// @details Safe to read from any thread while the backend runs.
+    const CallbackStats &getCallbackStats() const { return callbackStats; }
+
+    /// @brief The sample rate, buffer size and latency the output actually runs at. Valid after open().
+    const NegotiatedFormat &getFormat() const { return format; }
+
+    /// @brief Asks for the render thread to be raised and pinned. Call before start().
+    /// @details The render thread may belong to the host, so it places itself on its first buffer.
+    /// @param options The priority and the first core in options.cores are used
+    void setRealtimeOptions(const RealtimeOptions &options) {
+        realtimePriority = options.priority;
+        realtimeCore = options.coreFor(0);
+        placementDone.store(false, std::memory_order_relaxed);
+    }
+
+    /// @brief How the render thread was placed. Safe to call from any thread.
+    /// @return false until the render thread has placed itself
+    bool getThreadPlacement(ThreadPlacement &result) const {
+        if (!placementDone.load(std::memory_order_acquire)) {
+            return false;
+        }
+        result = placement;
+        return true;
+    }
+
+protected:
+    /// @brief Places the render thread as setRealtimeOptions() asked, the first time it is called.
+    /// @details Call at the top of every buffer. Afterwards it only checks a flag.
+    void placeRenderThread() {
+        if (placementDone.load(std::memory_order_relaxed)) {
+            return;
+        }
+        placement = placeCurrentThread(realtimePriority, realtimeCore);
+        placementDone.store(true, std::memory_order_release);
+    }
+
+    /// @brief Filled in by open().
+    NegotiatedFormat format;
+
+    /// @brief Filled in by the backend's render thread.
+    CallbackStats callbackStats;
+
+private:
+    int realtimePriority = 0;
+    int realtimeCore = -1;
+    ThreadPlacement placement;
+    std::atomic<bool> placementDone{false};
+};
+
+#endif //GRAPHICS_AUDIOBACKEND_H
@@ -0,0 +1,73 @@
+#include "callbackStats.h"
+
+CallbackSnapshot CallbackSnapshot::since(const CallbackSnapshot &earlier) const {
+    CallbackSnapshot delta;
+    for (int i = 0; i < BUCKETS; i++) {
+        delta.loadHistogram[i] = loadHistogram[i] - earlier.loadHistogram[i];
+    }
+    delta.callbacks = callbacks - earlier.callbacks;
+    delta.underflows = underflows - earlier.underflows;
+    delta.overflows = overflows - earlier.overflows;
+    return delta;
+}
+
+int CallbackSnapshot::loadPercentile(double fraction) const {
+    // Count from the histogram itself, which a concurrent snapshot may have read a few callbacks apart from the total
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        total += loadHistogram[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(fraction * total);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += loadHistogram[i];
+        if (seen > target) {
+            return i;
+        }
+    }
+    return MAX_LOAD_PERCENT;
+}
+
+int CallbackSnapshot::maxLoad() const {
+    for (int i = BUCKETS - 1; i >= 0; i--) {
+        if (loadHistogram[i] > 0) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+uint64_t CallbackSnapshot::xruns() const {
+    return underflows + overflows;
+}
+
+void CallbackStats::recordCallback(double seconds, double bufferSeconds) {
+    int bucket = bufferSeconds > 0.0 ? (int)(100.0 * seconds / bufferSeconds) : CallbackSnapshot::MAX_LOAD_PERCENT;
+    if (bucket > CallbackSnapshot::MAX_LOAD_PERCENT) {
+        bucket = CallbackSnapshot::MAX_LOAD_PERCENT;
+    }
+    loadHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    callbacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CallbackStats::recordUnderflow() {
+    underflows.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CallbackStats::recordOverflow() {
+    overflows.fetch_add(1, std::memory_order_relaxed);
+}
+
+CallbackSnapshot CallbackStats::snapshot() const {
+    CallbackSnapshot snapshot;
+    for (int i = 0; i < CallbackSnapshot::BUCKETS; i++) {
+        snapshot.loadHistogram[i] = loadHistogram[i].load(std::memory_order_relaxed);
+    }
+    snapshot.callbacks = callbacks.load(std::memory_order_relaxed);
+    snapshot.underflows = underflows.load(std::memory_order_relaxed);
+    snapshot.overflows = overflows.load(std::memory_order_relaxed);
+    return snapshot;
+}
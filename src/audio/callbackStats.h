@@ -0,0 +1,65 @@
+#ifndef GRAPHICS_CALLBACKSTATS_H
+#define GRAPHICS_CALLBACKSTATS_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief A copy of CallbackStats' counters at one moment.
+ * @details Taking the difference of two snapshots gives the numbers for the time between them.
+ */
+struct CallbackSnapshot {
+    /// @brief Histogram buckets: bucket i counts callbacks that used i% of their buffer's duration.
+    /// @details The last bucket collects everything at or above MAX_LOAD_PERCENT.
+    static constexpr int MAX_LOAD_PERCENT = 200;
+    static constexpr int BUCKETS = MAX_LOAD_PERCENT + 1;
+
+    uint64_t loadHistogram[BUCKETS] = {};
+    uint64_t callbacks = 0;
+    uint64_t underflows = 0;
+    uint64_t overflows = 0;
+
+    /// @brief The counts accumulated since an earlier snapshot of the same stats.
+    CallbackSnapshot since(const CallbackSnapshot &earlier) const;
+
+    /// @brief The callback load, in percent of the buffer duration, that a fraction of callbacks stayed under.
+    /// @param fraction 0.5 for the median, 0.99 for p99
+    /// @return the percentile, or 0 if there were no callbacks
+    int loadPercentile(double fraction) const;
+
+    /// @brief The highest load bucket with any callbacks in it.
+    int maxLoad() const;
+
+    /// @brief Output underflows plus overflows.
+    uint64_t xruns() const;
+};
+
+/**
+ * @brief Lock-free counters for how long audio callbacks take and how often the output glitches.
+ * @details One audio thread records into the stats; any other thread may take snapshots at any time.
+ * Recording is a few relaxed atomic increments, so it is safe inside the callback.
+ */
+class CallbackStats {
+public:
+    /// @brief Records one callback.
+    /// @param seconds How long the callback took
+    /// @param bufferSeconds How long the buffer it rendered lasts
+    void recordCallback(double seconds, double bufferSeconds);
+
+    /// @brief Records that the output ran out of data (PortAudio's paOutputUnderflow, or a missed timer deadline).
+    void recordUnderflow();
+
+    /// @brief Records that the output was handed more data than it could take (PortAudio's paOutputOverflow).
+    void recordOverflow();
+
+    /// @brief Copies the current counters.
+    CallbackSnapshot snapshot() const;
+
+private:
+    std::atomic<uint64_t> loadHistogram[CallbackSnapshot::BUCKETS] = {};
+    std::atomic<uint64_t> callbacks{0};
+    std::atomic<uint64_t> underflows{0};
+    std::atomic<uint64_t> overflows{0};
+};
+
+#endif //GRAPHICS_CALLBACKSTATS_H
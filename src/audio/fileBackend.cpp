@@ -0,0 +1,59 @@
+#include "fileBackend.h"
+
+#include <utility>
+
+namespace {
+
+bool endsWith(const std::string &text, const std::string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+FileBackend::FileBackend(Synth &synth, std::string path, unsigned long framesPerBuffer)
+        : TimerBackend(synth, framesPerBuffer), path(std::move(path)) {
+    wav = endsWith(this->path, ".wav") || endsWith(this->path, ".WAV");
+}
+
+FileBackend::~FileBackend() {
+    close();
+}
+
+bool FileBackend::open() {
+    if (wav) {
+        if (!wavWriter.open(path, (int)getSampleRate(), 2)) {
+            return false;
+        }
+    } else {
+        rawFile = fopen(path.c_str(), "wb");
+        if (rawFile == nullptr) {
+            return false;
+        }
+    }
+    return TimerBackend::open();
+}
+
+bool FileBackend::close() {
+    // Stop the timer thread before the file goes away
+    bool wasOpen = TimerBackend::close();
+    bool ok = true;
+    if (wav) {
+        ok = wavWriter.close();
+    } else if (rawFile != nullptr) {
+        ok = fclose(rawFile) == 0;
+        rawFile = nullptr;
+    }
+    return wasOpen && ok;
+}
+
+const char *FileBackend::getName() const {
+    return wav ? "wav file" : "raw file";
+}
+
+void FileBackend::consume(const float *buffer, unsigned long frames) {
+    if (wav) {
+        wavWriter.write(buffer, frames);
+    } else if (rawFile != nullptr) {
+        fwrite(buffer, sizeof(float), frames * 2, rawFile);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef GRAPHICS_FILEBACKEND_H
+#define GRAPHICS_FILEBACKEND_H
+
+#include <stdio.h>
+#include <string>
+
+#include "../synth/wavWriter.h"
+#include "timerBackend.h"
+
+/**
+ * @brief A timer backend that records the synth's output to a file in real time.
+ * @details Paths ending in .wav get a 16-bit PCM WAV file. Anything else gets raw interleaved
+ * 32-bit float samples in the machine's byte order, 2 channels at the synth's sample rate.
+ * The file is written from the timer thread, which is fine for a file but would not be for a device.
+ */
+class FileBackend : public TimerBackend {
+public:
+    /// @brief Construct a new FileBackend object
+    /// @param synth The synth to render
+    /// @param path The file to write
+    /// @param framesPerBuffer The number of frames rendered per timer tick
+    FileBackend(Synth &synth, std::string path, unsigned long framesPerBuffer = DEFAULT_FRAMES_PER_BUFFER);
+    ~FileBackend() override;
+
+    /// @brief Creates the file.
+    bool open() override;
+
+    /// @brief Stops rendering and finishes the file.
+    bool close() override;
+
+    const char *getName() const override;
+
+protected:
+    void consume(const float *buffer, unsigned long frames) override;
+
+private:
+    std::string path;
+    bool wav;
+    WavWriter wavWriter;
+    FILE *rawFile = nullptr;
+};
+
+#endif //GRAPHICS_FILEBACKEND_H
@@ -0,0 +1,39 @@
+#include "latencyConfig.h"
+
+unsigned long LatencyConfig::resolvedFramesPerBuffer() const {
+    return framesPerBuffer != 0 ? framesPerBuffer : profileFramesPerBuffer(profile);
+}
+
+unsigned long LatencyConfig::profileFramesPerBuffer(LatencyProfile profile) {
+    switch (profile) {
+        case LatencyProfile::UltraLow:
+            return 32;
+        case LatencyProfile::Low:
+            return 64;
+        case LatencyProfile::Safe:
+            return 512;
+    }
+    return 64;
+}
+
+const char *LatencyConfig::profileName(LatencyProfile profile) {
+    switch (profile) {
+        case LatencyProfile::UltraLow:
+            return "ultra-low";
+        case LatencyProfile::Low:
+            return "low";
+        case LatencyProfile::Safe:
+            return "safe";
+    }
+    return "low";
+}
+
+bool LatencyConfig::parseProfile(const std::string &name, LatencyProfile &profile) {
+    for (LatencyProfile candidate : {LatencyProfile::UltraLow, LatencyProfile::Low, LatencyProfile::Safe}) {
+        if (name == profileName(candidate)) {
+            profile = candidate;
+            return true;
+        }
+    }
+    return false;
+}
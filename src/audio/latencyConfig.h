@@ -0,0 +1,64 @@
+#ifndef GRAPHICS_LATENCYCONFIG_H
+#define GRAPHICS_LATENCYCONFIG_H
+
+#include <string>
+
+#include "sampleConverter.h"
+#include "../synth/realtimeThread.h"
+
+/**
+ * @brief How hard an output should push for low latency.
+ * @details Lower latency means smaller buffers and less slack before an underflow, so machines that
+ * glitch at UltraLow can step back to Low or Safe without touching the code.
+ */
+enum class LatencyProfile {
+    UltraLow, ///< 32-frame buffers and the smallest latency the device will take
+    Low,      ///< 64-frame buffers at the device's default low latency
+    Safe      ///< 512-frame buffers at the device's default high latency
+};
+
+/// @brief The latency and buffer settings an AudioBackend is asked to open with.
+struct LatencyConfig {
+    LatencyProfile profile = LatencyProfile::Low;
+
+    /// @brief Frames per callback, or 0 for the profile's size.
+    unsigned long framesPerBuffer = 0;
+
+    /// @brief Output sample rate in Hz, or 0 for the synth's rate.
+    double sampleRate = 0;
+
+    /// @brief The sample format to ask for first. Outputs that refuse it are offered the others in preference order.
+    SampleFormat sampleFormat = SampleFormat::Float32;
+
+    /// @brief Real-time priority, cores and memory locking for the threads that render.
+    RealtimeOptions realtime;
+
+    /// @brief framesPerBuffer if set, otherwise the profile's buffer size.
+    unsigned long resolvedFramesPerBuffer() const;
+
+    /// @brief The buffer size a profile uses when none is given explicitly.
+    static unsigned long profileFramesPerBuffer(LatencyProfile profile);
+
+    /// @brief "ultra-low", "low" or "safe".
+    static const char *profileName(LatencyProfile profile);
+
+    /// @brief Parses a profile name as printed by profileName().
+    /// @return false if the name is not a profile
+    static bool parseProfile(const std::string &name, LatencyProfile &profile);
+};
+
+/// @brief What a backend actually got from its output once open() succeeded.
+struct NegotiatedFormat {
+    double sampleRate = 0;
+
+    /// @brief Frames per callback, or 0 if the host picks the size of each callback.
+    unsigned long framesPerBuffer = 0;
+
+    /// @brief Seconds between a buffer being rendered and it being heard.
+    double outputLatency = 0;
+
+    /// @brief The format samples are handed to the output in.
+    SampleFormat sampleFormat = SampleFormat::Float32;
+};
+
+#endif //GRAPHICS_LATENCYCONFIG_H
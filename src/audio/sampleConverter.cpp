@@ -0,0 +1,175 @@
+#include "sampleConverter.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SYNTH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// @brief Samples quantized per pass before they are packed into the output.
+constexpr unsigned long BLOCK_SAMPLES = 256;
+
+/// @brief Turns the top 24 bits of a random word into a float in [0, 1).
+constexpr float RANDOM_SCALE = 1.0f / 16777216.0f;
+
+uint32_t xorshift(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+#ifdef SYNTH_X86
+__m128i xorshift(__m128i state) {
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+    state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+    return _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+}
+
+__m128 toUnit(__m128i random) {
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(random, 8)), _mm_set1_ps(RANDOM_SCALE));
+}
+#endif
+
+} // namespace
+
+SampleConverter::SampleConverter(SampleFormat format) : format(format), scalarState(0x9E3779B9u) {
+    // Any nonzero seeds will do; distinct ones keep the lanes uncorrelated
+    for (int i = 0; i < 8; i++) {
+        lanes[i] = 0x2545F491u * (uint32_t)(i + 1) + 0x6A09E667u;
+    }
+}
+
+SampleFormat SampleConverter::getFormat() const {
+    return format;
+}
+
+int SampleConverter::bytesPerSample(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Float32:
+            return 4;
+        case SampleFormat::Int24:
+            return 3;
+        case SampleFormat::Int16:
+            return 2;
+    }
+    return 4;
+}
+
+const char *SampleConverter::formatName(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Float32:
+            return "float32";
+        case SampleFormat::Int24:
+            return "int24";
+        case SampleFormat::Int16:
+            return "int16";
+    }
+    return "float32";
+}
+
+bool SampleConverter::parseFormat(const std::string &name, SampleFormat &format) {
+    for (SampleFormat candidate : {SampleFormat::Float32, SampleFormat::Int24, SampleFormat::Int16}) {
+        if (name == formatName(candidate)) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SampleConverter::convert(const float *in, void *out, unsigned long samples) {
+    if (format == SampleFormat::Float32) {
+        clipFloat(in, (float *)out, samples);
+        return;
+    }
+
+    alignas(16) int32_t quantized[BLOCK_SAMPLES];
+    unsigned char *bytes = (unsigned char *)out;
+    while (samples > 0) {
+        unsigned long block = samples < BLOCK_SAMPLES ? samples : BLOCK_SAMPLES;
+        if (format == SampleFormat::Int16) {
+            quantize(in, quantized, block, 32767.0f);
+            int16_t *pcm = (int16_t *)bytes;
+            unsigned long i = 0;
+#ifdef SYNTH_X86
+            for (; i + 8 <= block; i += 8) {
+                __m128i low = _mm_load_si128((const __m128i *)(quantized + i));
+                __m128i high = _mm_load_si128((const __m128i *)(quantized + i + 4));
+                _mm_storeu_si128((__m128i *)(pcm + i), _mm_packs_epi32(low, high));
+            }
+#endif
+            for (; i < block; i++) {
+                pcm[i] = (int16_t)quantized[i];
+            }
+            bytes += block * 2;
+        } else {
+            quantize(in, quantized, block, 8388607.0f);
+            // PortAudio's packed 24-bit samples are little endian, like every host this runs on
+            for (unsigned long i = 0; i < block; i++) {
+                uint32_t value = (uint32_t)quantized[i];
+                bytes[0] = (unsigned char)value;
+                bytes[1] = (unsigned char)(value >> 8);
+                bytes[2] = (unsigned char)(value >> 16);
+                bytes += 3;
+            }
+        }
+        in += block;
+        samples -= block;
+    }
+}
+
+void SampleConverter::clipFloat(const float *in, float *out, unsigned long samples) {
+    unsigned long i = 0;
+#ifdef SYNTH_X86
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    for (; i + 4 <= samples; i += 4) {
+        _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), low), high));
+    }
+#endif
+    for (; i < samples; i++) {
+        float sample = in[i];
+        out[i] = sample < -1.0f ? -1.0f : sample > 1.0f ? 1.0f : sample;
+    }
+}
+
+void SampleConverter::quantize(const float *in, int32_t *out, unsigned long samples, float scale) {
+    // Clipping after the dither keeps the rounded value inside the format; the dither spans one step either way
+    const float top = scale;
+    const float bottom = -scale - 1.0f;
+    unsigned long i = 0;
+#ifdef SYNTH_X86
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    const __m128 topVector = _mm_set1_ps(top);
+    const __m128 bottomVector = _mm_set1_ps(bottom);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    __m128i first = _mm_load_si128((const __m128i *)lanes);
+    __m128i second = _mm_load_si128((const __m128i *)(lanes + 4));
+    for (; i + 4 <= samples; i += 4) {
+        first = xorshift(first);
+        second = xorshift(second);
+        __m128 dither = _mm_sub_ps(toUnit(first), toUnit(second));
+        __m128 clipped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), minusOne), one);
+        __m128 value = _mm_add_ps(_mm_mul_ps(clipped, scaleVector), dither);
+        value = _mm_min_ps(_mm_max_ps(value, bottomVector), topVector);
+        _mm_store_si128((__m128i *)(out + i), _mm_cvtps_epi32(value));
+    }
+    _mm_store_si128((__m128i *)lanes, first);
+    _mm_store_si128((__m128i *)(lanes + 4), second);
+#endif
+    for (; i < samples; i++) {
+        float sample = in[i];
+        sample = sample < -1.0f ? -1.0f : sample > 1.0f ? 1.0f : sample;
+        float value = sample * scale + (nextRandom() - nextRandom());
+        value = value < bottom ? bottom : value > top ? top : value;
+        // Round to nearest like the SIMD path
+        out[i] = (int32_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+    }
+}
+
+float SampleConverter::nextRandom() {
+    return (xorshift(scalarState) >> 8) * RANDOM_SCALE;
+}
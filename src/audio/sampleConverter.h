@@ -0,0 +1,63 @@
+#ifndef GRAPHICS_SAMPLECONVERTER_H
+#define GRAPHICS_SAMPLECONVERTER_H
+
+#include <cstdint>
+#include <string>
+
+/// @brief The sample formats an output can take, in the order they are preferred.
+enum class SampleFormat {
+    Float32, ///< 32-bit float, clipped to [-1, 1]
+    Int24,   ///< packed 24-bit integers, three bytes per sample
+    Int16    ///< 16-bit integers
+};
+
+/**
+ * @brief Converts the synth's float samples to an output's sample format.
+ * @details Every format is clipped to full scale, so a loud chord saturates instead of wrapping or
+ * being handed to the device out of range. Integer formats get TPDF dither: the sum of two uniform
+ * random values of up to one step each is added before rounding, which turns rounding error into
+ * a constant low noise floor that does not follow the signal. Dither comes from a xorshift generator
+ * per SIMD lane, so the whole pass runs four samples at a time.
+ *
+ * Never allocates or blocks, so convert() can run in an audio callback. One instance per stream.
+ */
+class SampleConverter {
+public:
+    explicit SampleConverter(SampleFormat format = SampleFormat::Float32);
+
+    SampleFormat getFormat() const;
+
+    /// @brief Converts interleaved samples. For Float32, in and out may be the same buffer.
+    /// @param in The samples to convert
+    /// @param out Receives samples * bytesPerSample() bytes
+    /// @param samples The number of samples (frames times channels)
+    void convert(const float *in, void *out, unsigned long samples);
+
+    /// @brief The size of one converted sample.
+    static int bytesPerSample(SampleFormat format);
+
+    /// @brief "float32", "int24" or "int16".
+    static const char *formatName(SampleFormat format);
+
+    /// @brief Parses a format name as printed by formatName().
+    /// @return false if the name is not a format
+    static bool parseFormat(const std::string &name, SampleFormat &format);
+
+private:
+    void clipFloat(const float *in, float *out, unsigned long samples);
+
+    /// @brief Clips, dithers and rounds to integers of full scale 2^(bits - 1), one int32 per sample.
+    /// @details Runs in blocks so the integers can be packed to the output format straight after.
+    void quantize(const float *in, int32_t *out, unsigned long samples, float scale);
+
+    /// @brief One uniform random value in [0, 1) from the scalar generator.
+    float nextRandom();
+
+    SampleFormat format;
+
+    /// @brief Per-lane generator state for the SIMD path, then the scalar generator's.
+    alignas(16) uint32_t lanes[8];
+    uint32_t scalarState;
+};
+
+#endif //GRAPHICS_SAMPLECONVERTER_H
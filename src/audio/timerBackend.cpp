@@ -0,0 +1,112 @@
+#include "timerBackend.h"
+
+#include <chrono>
+
+#include "../synth/denormals.h"
+#include "../synth/realtimeGuard.h"
+
+using Clock = std::chrono::steady_clock;
+
+TimerBackend::TimerBackend(Synth &synth, unsigned long framesPerBuffer)
+        : synth(synth), framesPerBuffer(framesPerBuffer) {}
+
+TimerBackend::~TimerBackend() {
+    stop();
+}
+
+double TimerBackend::getSampleRate() const {
+    return synth.getSampleRate();
+}
+
+bool TimerBackend::open() {
+    buffer.assign(framesPerBuffer * 2, 0.0f);
+    format.sampleRate = synth.getSampleRate();
+    format.framesPerBuffer = framesPerBuffer;
+    // Each buffer is played one period after the events in it were stamped
+    format.outputLatency = framesPerBuffer / synth.getSampleRate();
+    opened = true;
+    return true;
+}
+
+bool TimerBackend::start() {
+    if (!opened || running)
+        return false;
+
+    running = true;
+    thread = std::thread(&TimerBackend::run, this);
+    return true;
+}
+
+bool TimerBackend::stop() {
+    if (!running)
+        return false;
+
+    running = false;
+    thread.join();
+    return true;
+}
+
+bool TimerBackend::close() {
+    if (!opened)
+        return false;
+
+    stop();
+    opened = false;
+    return true;
+}
+
+double TimerBackend::time() const {
+    return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+void TimerBackend::run() {
+    ScopedFlushToZero flushToZero;
+    placeRenderThread();
+    const double bufferSeconds = framesPerBuffer / synth.getSampleRate();
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(bufferSeconds));
+    auto deadline = Clock::now() + period;
+
+    while (running) {
+        // Each render runs as the period before deadline starts, so the events stamped so far fall in the one
+        // before that. Like a sound card, play the buffer a period late: its first frame is the previous period's
+        // start, and an event stamped during that period lands at its offset inside the buffer.
+        double bufferTime = std::chrono::duration<double>((deadline - 2 * period).time_since_epoch()).count();
+        auto callbackStart = Clock::now();
+        {
+            // Only the render stands in for a sound card callback; consume() may write to a file
+            ScopedRealtimeThread realtime;
+            synth.render(buffer.data(), framesPerBuffer, bufferTime);
+        }
+        consume(buffer.data(), framesPerBuffer);
+        auto callbackEnd = Clock::now();
+
+        callbackStats.recordCallback(std::chrono::duration<double>(callbackEnd - callbackStart).count(), bufferSeconds);
+        // A sound card would have run dry if the buffer was not ready by its deadline
+        if (callbackEnd > deadline) {
+            callbackStats.recordUnderflow();
+        }
+
+        std::this_thread::sleep_until(deadline);
+        deadline += period;
+
+        // After a long stall, skip the missed buffers instead of rendering them back to back
+        if (Clock::now() > deadline + 4 * period) {
+            deadline = Clock::now() + period;
+        }
+    }
+}
+
+NullBackend::NullBackend(Synth &synth, unsigned long framesPerBuffer) : TimerBackend(synth, framesPerBuffer) {}
+
+NullBackend::~NullBackend() {
+    close();
+}
+
+const char *NullBackend::getName() const {
+    return "null";
+}
+
+void NullBackend::consume(const float *buffer, unsigned long frames) {
+    (void) buffer;
+    (void) frames;
+}
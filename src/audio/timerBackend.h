@@ -0,0 +1,64 @@
+#ifndef GRAPHICS_TIMERBACKEND_H
+#define GRAPHICS_TIMERBACKEND_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "audioBackend.h"
+
+/**
+ * @brief A backend that pulls buffers from the synth on a high-resolution timer instead of a device.
+ * @details A worker thread renders one buffer every framesPerBuffer / sampleRate seconds, paced with
+ * std::chrono::steady_clock, and hands it to consume(). Subclasses decide what happens to the audio.
+ */
+class TimerBackend : public AudioBackend {
+public:
+    /// @brief Destroy the TimerBackend object. Subclasses must call close() in their own destructor.
+    ~TimerBackend() override;
+
+    bool open() override;
+    bool start() override;
+    bool stop() override;
+    bool close() override;
+    double time() const override;
+
+protected:
+    /// @brief Construct a new TimerBackend object
+    /// @param synth The synth to render
+    /// @param framesPerBuffer The number of frames rendered per timer tick
+    TimerBackend(Synth &synth, unsigned long framesPerBuffer);
+
+    /// @brief Receives each rendered buffer on the timer thread.
+    /// @param buffer Interleaved stereo samples
+    /// @param frames The number of frames in the buffer
+    virtual void consume(const float *buffer, unsigned long frames) = 0;
+
+    /// @brief The rate the synth renders at, and so the rate of every consumed buffer.
+    double getSampleRate() const;
+
+private:
+    /// @brief The timer thread's loop.
+    void run();
+
+    Synth &synth;
+    unsigned long framesPerBuffer;
+    std::vector<float> buffer;
+    bool opened = false;
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
+
+/// @brief A timer backend that throws the audio away. Lets the engine run and be timed on machines without a sound card.
+class NullBackend : public TimerBackend {
+public:
+    explicit NullBackend(Synth &synth, unsigned long framesPerBuffer = DEFAULT_FRAMES_PER_BUFFER);
+    ~NullBackend() override;
+
+    const char *getName() const override;
+
+protected:
+    void consume(const float *buffer, unsigned long frames) override;
+};
+
+#endif //GRAPHICS_TIMERBACKEND_H
@@ -1,10 +1,43 @@
 #include "engine.h"
+#include <algorithm>
+#include <thread>
 #include <vector>       // Include the vector header
 #include <GLFW/glfw3.h> // Include GLFW header for key codes
 
 enum state {start, freePlay, gamePlay, over};
+
+// Keyboard keys bound to each piano key. White keys are on the bottom row, black keys above them.
+const PianoKeyBinding keyBindings[] = {
+        // White keys
+        {'Z', 0, 60, false}, // C4
+        {'X', 1, 62, false}, // D4
+        {'C', 2, 64, false}, // E4
+        {'V', 3, 65, false}, // F4
+        {'B', 4, 67, false}, // G4
+        {'N', 5, 69, false}, // A4
+        {'M', 6, 71, false}, // B4
+        // Black keys
+        {'S', 7, 61, true},  // C#4
+        {'D', 8, 63, true},  // D#4
+        {'G', 9, 66, true},  // F#4
+        {'H', 10, 68, true}, // G#4
+        {'J', 11, 70, true}, // A#4
+};
 state screen;
 
+// Mary Had a Little Lamb, played before it is the player's turn: start time and length in seconds, then the note
+// 2-1-0-1-0-0-0
+// 1-1-1
+// 2-4-4
+// 2-1-0-1-2-2-2-2-1-1-2-1-0
+const SequenceNote maryHadALittleLamb[] = {
+        {8, 1, 64}, {10, 1, 62}, {12, 1, 60}, {14, 1, 62}, {16, 1, 64}, {18, 1, 64}, {20, 1, 64},
+        {24, 1, 62}, {26, 1, 62}, {28, 1, 62},
+        {31, 1, 64}, {33, 1, 67}, {35, 1, 67},
+        {38, 1, 64}, {40, 1, 62}, {42, 1, 60}, {44, 1, 62}, {46, 1, 64}, {48, 1, 64}, {50, 1, 64},
+        {52, 1, 64}, {54, 1, 62}, {56, 1, 62}, {58, 1, 64}, {60, 1, 62}, {62, 1, 60},
+};
+
 // Instructions variables to keep track of the elapsed time
 float elapsedTime = 0.0f;
 bool showText = true;
@@ -12,8 +45,10 @@ bool showText = true;
 // Colors
 color originalFill, hoverFill, pressFill, blackKey, whiteKey;
 
-Engine::Engine() : keys() {
+Engine::Engine(const string &audioOutput, const LatencyConfig &latency, const string &samplePackPath,
+               const string &reverbPath, const Tuning &tuning) : keys() {
     this->initWindow();
+    this->initAudio(audioOutput, latency, samplePackPath, reverbPath, tuning);
     this->initShaders();
     this->initShapes();
     this->processInput();
@@ -25,8 +60,6 @@ Engine::Engine() : keys() {
     blackKey = {0, 0, 0, 1};
     whiteKey = {1, 1, 1, 1};
 
-    isPlaying = false;
-
 }
 
 Engine::~Engine() {}
@@ -59,19 +92,109 @@ unsigned int Engine::initWindow(bool debug) {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glfwSwapInterval(1);
 
-    // Audio stream errors
-    if( paInit.result() != paNoError ) {
-        fprintf( stderr, "An error occurred while using the portaudio stream\n" );
-        fprintf( stderr, "Error number: %d\n", paInit.result() );
-        fprintf( stderr, "Error message: %s\n", Pa_GetErrorText( paInit.result() ) );
-        return -1;
+    return 0;
+}
+
+void Engine::initAudio(const string &audioOutput, const LatencyConfig &latency, const string &samplePackPath,
+                       const string &reverbPath, const Tuning &tuning) {
+    // Fall back to the wavetables if the pack cannot be read
+    if (!samplePackPath.empty()) {
+        string error;
+        if (samplePack.open(samplePackPath, error)) {
+            synth.setSamplePack(&samplePack);
+            cout << "Sample pack: " << samplePack.getZoneCount() << " zones, "
+                 << samplePack.getResidentBytes() / 1024 << " KiB resident" << endl;
+        } else {
+            cout << "Could not open sample pack " << samplePackPath << ": " << error << endl;
+        }
     }
 
-    // Opens sound streams
-    sine.open(Pa_GetDefaultOutputDevice());
-    sound_engine.run();
+    // Play dry if the impulse response cannot be read
+    if (reverbPath == "room") {
+        synth.setReverb(Synth::roomImpulseResponse());
+    } else if (!reverbPath.empty()) {
+        vector<float> impulseResponse;
+        int sampleRate = 0;
+        string error;
+        if (WavReader::loadMono(reverbPath, impulseResponse, sampleRate, error)) {
+            synth.setReverb(impulseResponse, sampleRate);
+            cout << "Reverb: " << impulseResponse.size() / (double)sampleRate << " s impulse response" << endl;
+        } else {
+            cout << "Could not read impulse response " << reverbPath << ": " << error << endl;
+        }
+    }
 
-    return 0;
+    // Switching temperament starts from the one the tuning was given and keeps its A4
+    synth.setTuning(tuning);
+    temperamentActive = tuning.getTemperament(temperament);
+    if (tuning.getFrequency(69) > 0.0) {
+        tuningReference = tuning.getFrequency(69);
+    }
+    cout << "Tuning: " << tuning.getName() << endl;
+
+    // The song's times are turned into sample positions now and again if the rate changes, never while it plays
+    demoSong = Sequence(vector<SequenceNote>(std::begin(maryHadALittleLamb), std::end(maryHadALittleLamb)));
+    synth.setSequence(&demoSong);
+
+    // The sound card picks its native rate unless one was asked for; the other outputs run at whatever was asked for
+    if (latency.sampleRate > 0) {
+        synth.setSampleRate(latency.sampleRate);
+    }
+
+    if (audioOutput.empty() || audioOutput == "portaudio") {
+        audioBackend = make_unique<PortAudioBackend>(synth, latency);
+    } else if (audioOutput == "null") {
+        audioBackend = make_unique<NullBackend>(synth, latency.resolvedFramesPerBuffer());
+    } else {
+        audioBackend = make_unique<FileBackend>(synth, audioOutput, latency.resolvedFramesPerBuffer());
+    }
+
+    // Keep running without sound rather than failing when there is no usable output device
+    if (!audioBackend->open()) {
+        cout << "Could not open " << audioBackend->getName() << " audio output, continuing without sound" << endl;
+        audioBackend = make_unique<NullBackend>(synth, latency.resolvedFramesPerBuffer());
+        audioBackend->open();
+    }
+
+    // Report what the output really runs at, which can differ from what was asked for
+    const NegotiatedFormat &format = audioBackend->getFormat();
+    cout << "Audio output: " << audioBackend->getName() << ", " << format.sampleRate << " Hz "
+         << SampleConverter::formatName(format.sampleFormat) << ", ";
+    if (format.framesPerBuffer == 0) {
+        cout << "host-chosen buffer size, ";
+    } else {
+        cout << format.framesPerBuffer << " frames per buffer, ";
+    }
+    cout << format.outputLatency * 1000.0 << " ms output latency" << endl;
+
+    // Dense chords are split across spare cores. Leave one core for the audio thread and one for the window,
+    // since the helpers spin while they have work.
+    unsigned cores = std::thread::hardware_concurrency();
+    synth.setRenderThreads(cores >= 4 ? std::min(3, (int)cores - 2) : 0, latency.realtime);
+    audioBackend->setRealtimeOptions(latency.realtime);
+    if (latency.realtime.priority > 0 || !latency.realtime.cores.empty()) {
+        for (int thread = 0; thread < synth.getRenderThreads(); thread++) {
+            cout << describePlacement("Render thread " + std::to_string(thread + 1), synth.getRenderThreadPlacement(thread)) << endl;
+        }
+        audioPlacementPending = true;
+    }
+
+    // Fault in everything the callback reads before it first runs
+    synth.prefault();
+
+    // The backend runs until the engine closes, notes just switch voices on and off.
+    audioBackend->start();
+
+    // Locked after the warm-up, so the pages the callback has touched since are kept too. The sample pack stays
+    // pageable: only its heads, copied into memory, are on the audio path, and the streamer releases the rest as it goes.
+    if (latency.realtime.lockMemory) {
+        string error;
+        if (lockProcessMemory(error, samplePack.getMapping(), samplePack.getMappingSize())) {
+            cout << "Memory locked" << endl;
+        } else {
+            cout << "Could not lock memory, page faults may still glitch the audio: " << error << endl;
+        }
+    }
 }
 
 void Engine::initShaders() {
@@ -102,8 +225,6 @@ void Engine::initShapes() {
         piano.push_back(make_unique<Rect>(shapeShader, vec2{keyX, keyY}, vec2{keyWidth, height / 2}, color{1, 1, 1, 1}));
         // Get the index of the current key in the loop
         int keyIndex = (i - 100) / 100;
-//        sounds.push_back(SoundEngine());
-//        sounds[sounds.size()-1].run();
     }
 
     // Add black keys (sharps/flats)
@@ -118,8 +239,11 @@ void Engine::initShapes() {
         float keyY = height / 4 * 1.5; // Offset from white keys
         piano.push_back(make_unique<Rect>(shapeShader, vec2{keyX, keyY}, vec2{blackKeyWidth, blackKeyHeight}, color{0, 0, 0, 1}));
         int keyIndex = (i - 150) / 100;
-//        sounds.push_back(SoundEngine());
-//        sounds[sounds.size()-1].run();
+    }
+
+    // Pan each note to where its key is drawn, left edge of the window to the right edge
+    for (const PianoKeyBinding &binding : keyBindings) {
+        synth.setNotePan(binding.note, 2.0f * piano[binding.pianoIndex]->getPosX() / width - 1.0f);
     }
 
 }
@@ -139,15 +263,42 @@ void Engine::processInput() {
     // Close window if escape key is pressed
     if (keys[GLFW_KEY_ESCAPE]) {
         glfwSetWindowShouldClose(window, true);
-        sine.stop();
-        sine.close();
-        //sound_engine.stopSine();
+        audioBackend->stop();
+        audioBackend->close();
     }
 
     // Go back to start screen if left arrow key is pressed
     if (keys[GLFW_KEY_LEFT]) {
         screen = start;
-        //sound_engine.stopSine();
+        double now = audioBackend->time();
+        synth.stopSequence(now);
+        synth.allNotesOff(now);
+    }
+
+    // Switch between the wavetable and the waveguide piano if F2 is pressed
+    if (keys[GLFW_KEY_F2] && !keysLastFrame[GLFW_KEY_F2]) {
+        bool waveguide = synth.getVoiceModel() != VoiceModel::Waveguide;
+        synth.setVoiceModel(waveguide ? VoiceModel::Waveguide : VoiceModel::Wavetable);
+        cout << "Voice model: " << (waveguide ? "waveguide strings" : "wavetable") << endl;
+    }
+
+    // Step through the temperaments if F3 is pressed; the new table is built here and swapped in at the next buffer
+    if (keys[GLFW_KEY_F3] && !keysLastFrame[GLFW_KEY_F3]) {
+        if (temperamentActive) {
+            temperament = (Temperament)(((int)temperament + 1) % (int)Temperament::COUNT);
+            synth.setTuning(Tuning::fromTemperament(temperament, tuningReference));
+            cout << "Tuning: " << synth.getTuning().getName() << endl;
+        } else {
+            cout << "Tuning: " << synth.getTuning().getName() << " is a Scala scale, F3 only steps through temperaments" << endl;
+        }
+    }
+
+    // Toggle the audio callback overlay if F1 is pressed
+    if (keys[GLFW_KEY_F1] && !keysLastFrame[GLFW_KEY_F1]) {
+        showAudioStats = !showAudioStats;
+        audioStatsStart = audioBackend->getCallbackStats().snapshot();
+        audioStatsStartTime = glfwGetTime();
+        audioStatsText = "Measuring audio...";
     }
 
     // Mouse position saved to check for collisions
@@ -156,15 +307,12 @@ void Engine::processInput() {
     // If we're in the start screen and the user presses s, change screen to free play screen
     if (screen == start && keys[GLFW_KEY_S]) {
         screen = freePlay;
-        sine.stop();
-        // sound_engine.makeSine(400);
     }
 
     // If we're in the start screen and the user presses p, change screen to play the games activity
     if (screen == start && keys[GLFW_KEY_P]) {
         screen = gamePlay;
-        sine.stop();
-        // sound_engine.makeSine();
+        synth.startSequence(audioBackend->time());
     }
 
     // Mouse position is inverted because the origin of the window is in the top left corner
@@ -178,423 +326,40 @@ void Engine::processInput() {
 
 ////// EACH PIANO KEY IS REPRESENTED BY A KEY ON THE KEYBOARD //////
 
-//// WHITE KEYS ////
-
-    if (screen == freePlay) {
-        if (keys['Z'] && !keysLastFrame['Z']) {
-            sine.start();
-//            sounds[0].makeSine(460.0f);
-            // Highlight C key when pressed
-            if (!piano.empty()) {
-                piano[0]->setColor(pressFill);
-            }
-        } else if(!keys['Z'] && keysLastFrame['Z']) {
-            sine.stop();
-            //sound_engine.stopSine(340.0);
-            //sounds[0].stopSine(460.0f);
-            // Reset color
-            if (!piano.empty()) {
-                piano[0]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['X'] && !keysLastFrame['X']) {
-            sine.start();
-//            sounds[0].makeSine(460.0f);
-            // Highlight C key when pressed
-            if (!piano.empty()) {
-                piano[1]->setColor(pressFill);
-            }
-        } else if(!keys['X'] && keysLastFrame['X']) {
-            sine.stop();
-            //sound_engine.stopSine(340.0);
-            //sounds[0].stopSine(460.0f);
-            // Reset color
-            if (!piano.empty()) {
-                piano[1]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['C'] && !keysLastFrame['C']) {
-            sine.start();
-            // Highlight C key when pressed
-            if (!piano.empty()) {
-                piano[2]->setColor(pressFill);
-            }
-        } else if(!keys['C'] && keysLastFrame['C']) {
-            sine.stop();
-            //sound_engine.stopSine(340.0);
-            //sounds[0].stopSine(460.0f);
-            // Reset color
-            if (!piano.empty()) {
-                piano[2]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['V'] && !keysLastFrame['V']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[3]->setColor(pressFill);
-            }
-        } else if(!keys['V'] && keysLastFrame['V']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[3]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['B'] && !keysLastFrame['B']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[4]->setColor(pressFill);
-            }
-        } else if(!keys['B'] && keysLastFrame['B']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[4]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['N'] && !keysLastFrame['N']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[5]->setColor(pressFill);
-            }
-        } else if(!keys['N'] && keysLastFrame['N']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[5]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['M'] && !keysLastFrame['M']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[6]->setColor(pressFill);
-            }
-        } else if(!keys['M'] && keysLastFrame['M']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[6]->setColor(whiteKey);
-            }
-        }
-    }
-
-    //// Black KEYS ////
-
-    if (screen == freePlay) {
-        if (keys['S'] && !keysLastFrame['S']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[7]->setColor(pressFill);
-            }
-        } else if(!keys['S'] && keysLastFrame['S']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[7]->setColor(blackKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['D'] && !keysLastFrame['D']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[8]->setColor(pressFill);
-            }
-        } else if(!keys['D'] && keysLastFrame['D']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[8]->setColor(blackKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['G'] && !keysLastFrame['G']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[9]->setColor(pressFill);
-            }
-        } else if(!keys['G'] && keysLastFrame['G']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[9]->setColor(blackKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['H'] && !keysLastFrame['H']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[10]->setColor(pressFill);
-            }
-        } else if(!keys['H'] && keysLastFrame['H']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[10]->setColor(blackKey);
-            }
-        }
-    }
-
-    if (screen == freePlay) {
-        if (keys['J'] && !keysLastFrame['J']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[11]->setColor(pressFill);
-            }
-        } else if(!keys['J'] && keysLastFrame['J']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[11]->setColor(blackKey);
-            }
-        }
-    }
-
-
-    // game play key sounds
-    ////// EACH PIANO KEY IS REPRESENTED BY A KEY ON THE KEYBOARD //////
-
-//// WHITE KEYS ////
-
-    if (screen == gamePlay) {
-        if (keys['Z'] && !keysLastFrame['Z']) {
-            sine.start();
-//            sounds[0].makeSine(460.0f);
-            // Highlight C key when pressed
-            if (!piano.empty()) {
-                piano[0]->setColor(pressFill);
-            }
-        } else if(!keys['Z'] && keysLastFrame['Z']) {
-            sine.stop();
-            //sound_engine.stopSine(340.0);
-            //sounds[0].stopSine(460.0f);
-            // Reset color
-            if (!piano.empty()) {
-                piano[0]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == gamePlay) {
-        if (keys['X'] && !keysLastFrame['X']) {
-            sine.start();
-//            sounds[0].makeSine(460.0f);
-            // Highlight C key when pressed
-            if (!piano.empty()) {
-                piano[1]->setColor(pressFill);
-            }
-        } else if(!keys['X'] && keysLastFrame['X']) {
-            sine.stop();
-            //sound_engine.stopSine(340.0);
-            //sounds[0].stopSine(460.0f);
-            // Reset color
-            if (!piano.empty()) {
-                piano[1]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == gamePlay) {
-        if (keys['C'] && !keysLastFrame['C']) {
-            sine.start();
-            // Highlight C key when pressed
-            if (!piano.empty()) {
-                piano[2]->setColor(pressFill);
-            }
-        } else if(!keys['C'] && keysLastFrame['C']) {
-            sine.stop();
-            //sound_engine.stopSine(340.0);
-            //sounds[0].stopSine(460.0f);
-            // Reset color
-            if (!piano.empty()) {
-                piano[2]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == gamePlay) {
-        if (keys['V'] && !keysLastFrame['V']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[3]->setColor(pressFill);
-            }
-        } else if(!keys['V'] && keysLastFrame['V']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[3]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == gamePlay) {
-        if (keys['B'] && !keysLastFrame['B']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[4]->setColor(pressFill);
-            }
-        } else if(!keys['B'] && keysLastFrame['B']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[4]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == gamePlay) {
-        if (keys['N'] && !keysLastFrame['N']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[5]->setColor(pressFill);
-            }
-        } else if(!keys['N'] && keysLastFrame['N']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[5]->setColor(whiteKey);
-            }
-        }
-    }
-
-    if (screen == gamePlay) {
-        if (keys['M'] && !keysLastFrame['M']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[6]->setColor(pressFill);
-            }
-        } else if(!keys['M'] && keysLastFrame['M']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[6]->setColor(whiteKey);
-            }
-        }
-    }
-
-    //// Black KEYS ////
-
-    if (screen == gamePlay) {
-        if (keys['S'] && !keysLastFrame['S']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[7]->setColor(pressFill);
-            }
-        } else if(!keys['S'] && keysLastFrame['S']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[7]->setColor(blackKey);
-            }
-        }
-    }
-
-    if (screen == gamePlay) {
-        if (keys['D'] && !keysLastFrame['D']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[8]->setColor(pressFill);
-            }
-        } else if(!keys['D'] && keysLastFrame['D']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[8]->setColor(blackKey);
-            }
-        }
-    }
-
-    if (screen == gamePlay) {
-        if (keys['G'] && !keysLastFrame['G']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[9]->setColor(pressFill);
-            }
-        } else if(!keys['G'] && keysLastFrame['G']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[9]->setColor(blackKey);
-            }
-        }
-    }
+    if (screen == freePlay || screen == gamePlay) {
+        // Timestamp this frame's key changes on the audio clock
+        double now = audioBackend->time();
 
-    if (screen == gamePlay) {
-        if (keys['H'] && !keysLastFrame['H']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[10]->setColor(pressFill);
-            }
-        } else if(!keys['H'] && keysLastFrame['H']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[10]->setColor(blackKey);
+        for (const PianoKeyBinding &binding : keyBindings) {
+            if (keys[binding.key] && !keysLastFrame[binding.key]) {
+                synth.noteOn(binding.note, now);
+                // Highlight key when pressed
+                if (!piano.empty()) {
+                    piano[binding.pianoIndex]->setColor(pressFill);
+                }
+            } else if (!keys[binding.key] && keysLastFrame[binding.key]) {
+                synth.noteOff(binding.note, now);
+                // Reset color
+                if (!piano.empty()) {
+                    piano[binding.pianoIndex]->setColor(binding.black ? blackKey : whiteKey);
+                }
             }
         }
-    }
 
-    if (screen == gamePlay) {
-        if (keys['J'] && !keysLastFrame['J']) {
-            sine.start();
-            if (!piano.empty()) {
-                piano[11]->setColor(pressFill);
-            }
-        } else if(!keys['J'] && keysLastFrame['J']) {
-            sine.stop();
-            // Reset color
-            if (!piano.empty()) {
-                piano[11]->setColor(blackKey);
-            }
+        // Space is the sustain pedal
+        if (keys[GLFW_KEY_SPACE] != keysLastFrame[GLFW_KEY_SPACE]) {
+            synth.setSustain(keys[GLFW_KEY_SPACE], now);
         }
-    } // end game play key sounds
 
-    if(screen == gamePlay) {
         // if mouse pressed now and not pressed last frame
-        // make sound
+        // play the first key
         if (keyOverlapsMouse && mousePressed && !mousePressedLastFrame) {
-            sound_engine.makeSine(440);
+            synth.noteOn(keyBindings[0].note, now);
         }
         // if mouse pressed now false and it was pressed last frame
         // stop sound
         if (keyOverlapsMouse && !mousePressed && mousePressedLastFrame) {
-            sound_engine.stopSine(440);
-        }
-    }
-
-    if(screen == freePlay) {
-        // if mousepressed now and not pressed last frame
-        // make sound
-        if (keyOverlapsMouse && mousePressed && !mousePressedLastFrame) {
-            sound_engine.makeSine(880);
-        }
-        // if mousepressed now false and it was pressed last frame
-        // stop sound
-        if (keyOverlapsMouse && !mousePressed && mousePressedLastFrame) {
-            sound_engine.stopSine(880);
+            synth.noteOff(keyBindings[0].note, now);
         }
     }
 
@@ -614,15 +379,15 @@ void Engine::update() {
     lastFrame = currentFrame;
     bool playedRight = false;
 
-//    for (int i = 0; i < piano.size(); ++i) {
-//        if (playSound[i]) {
-//            // Start the sine wave associated with the pressed key
-//            sound_engine.makeSine(frequencies[i]);
-//        } else {
-//            // Stop the sine wave associated with the released key
-//            sound_engine.stopSine(frequencies[i]);
-//        }
-//    }
+    // The audio thread places itself on its first buffer, so its report comes once that has run
+    ThreadPlacement audioPlacement;
+    if (audioPlacementPending && audioBackend->getThreadPlacement(audioPlacement)) {
+        cout << describePlacement("Audio thread", audioPlacement) << endl;
+        audioPlacementPending = false;
+    }
+
+    // Snapshots the audio callback was still reading when they were replaced are freed here, off the audio thread
+    synth.reclaimSnapshots();
 
     // TODO: When in gamePlay mode, end the game when the user correctly plays the song
     if(screen == gamePlay && playedRight){
@@ -671,10 +436,6 @@ void Engine::render() {
             // Reset elapsedTime every time user is on start screen
             elapsedTime = 0.0f;
 
-            if (!isPlaying) {
-                sine.start();
-            }
-
             break;
         }
 
@@ -767,335 +528,13 @@ void Engine::render() {
 
 
             //// GAME LOGIC FOR MARY HAD A LITTLE LAMB////
-//            Mary Had a Little Lamb
-//            2-1-0-1-0-0-0
-//            1-1-1
-//            2-4-4
-//            2-1-0-1-2-2-2-2-1-1-2-1-0
-
-            // Play First Line
-            // 2-1-0-1-0-0-0
-
-            // Check if elapsedTime is within the 8 sec buffer time + the time to play the sound (1 sec)
-            if (elapsedTime > 8.0f && elapsedTime < 9.0f) {
-                // Start playing the sound and change color for piano[2]
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 9.0f && elapsedTime < 10.0f) { // Ensure sound stops after 1 second
-                // Stop the sound and reset color for piano[1]
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 10.0f && elapsedTime < 11.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 11.0f && elapsedTime < 12.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 12.0f && elapsedTime < 13.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[0]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 13.0f && elapsedTime < 14.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[0]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 14.0f && elapsedTime < 15.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 15.0f && elapsedTime < 16.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 16.0f && elapsedTime < 17.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 17.0f && elapsedTime < 18.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 18.0f && elapsedTime < 19.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 19.0f && elapsedTime < 20.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 20.0f && elapsedTime < 21.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 21.0f && elapsedTime < 22.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            // Second Line
-            // 1-1-1
-            if (elapsedTime > 24.0f && elapsedTime < 25.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 25.0f && elapsedTime < 26.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 26.0f && elapsedTime < 27.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 27.0f && elapsedTime < 28.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 28.0f && elapsedTime < 29.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 29.0f && elapsedTime < 30.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            // Third Line
-            //  2-4-4
-
-            if (elapsedTime > 31.0f && elapsedTime < 32.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 32.0f && elapsedTime < 33.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 33.0f && elapsedTime < 34.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[4]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 34.0f && elapsedTime < 35.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[4]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 35.0f && elapsedTime < 36.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[4]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 36.0f && elapsedTime < 37.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[4]->setColor(whiteKey);
-                }
-            }
-
-            // Fourth Line
-            // 2-1-0-1-2-2-2-2-1-1-2-1-0
-            if (elapsedTime > 38.0f && elapsedTime < 39.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 39.0f && elapsedTime < 40.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 40.0f && elapsedTime < 41.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 41.0f && elapsedTime < 42.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 42.0f && elapsedTime < 43.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[0]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 43.0f && elapsedTime < 44.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[0]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 44.0f && elapsedTime < 45.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 45.0f && elapsedTime < 46.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 46.0f && elapsedTime < 47.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 47.0f && elapsedTime < 48.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 48.0f && elapsedTime < 49.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 49.0f && elapsedTime < 50.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 50.0f && elapsedTime < 51.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 51.0f && elapsedTime < 52.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 52.0f && elapsedTime < 53.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 53.0f && elapsedTime < 54.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 54.0f && elapsedTime < 55.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 55.0f && elapsedTime < 56.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 56.0f && elapsedTime < 57.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 57.0f && elapsedTime < 58.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 58.0f && elapsedTime < 59.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[2]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 59.0f && elapsedTime < 60.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[2]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 60.0f && elapsedTime < 61.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[1]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 61.0f && elapsedTime < 62.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[1]->setColor(whiteKey);
-                }
-            }
-
-            if (elapsedTime > 62.0f && elapsedTime < 63.0f) {
-                sine.start();
-                if (!piano.empty()) {
-                    piano[0]->setColor(pressFill);
-                }
-            } else if (elapsedTime >= 63.0f && elapsedTime < 64.0f) {
-                sine.stop();
-                if (!piano.empty()) {
-                    piano[0]->setColor(whiteKey);
+            // The synth plays the song from the audio callback; light the keys it is holding down
+            for (const PianoKeyBinding &binding : keyBindings) {
+                bool lit = synth.isSequenceNoteDown(binding.note);
+                if (lit != songNoteLit[binding.note] && !piano.empty()) {
+                    piano[binding.pianoIndex]->setColor(lit ? pressFill : binding.black ? blackKey : whiteKey);
                 }
+                songNoteLit[binding.note] = lit;
             }
 
             //// Program stops playing song here ////
@@ -1123,9 +562,32 @@ void Engine::render() {
             break;
         }
     }
+
+    if (showAudioStats) {
+        renderAudioStats();
+    }
+
     glfwSwapBuffers(window);
 }
 
+void Engine::renderAudioStats() {
+    double now = glfwGetTime();
+    if (now - audioStatsStartTime >= 1.0) {
+        CallbackSnapshot current = audioBackend->getCallbackStats().snapshot();
+        CallbackSnapshot interval = current.since(audioStatsStart);
+        audioStatsText = string(audioBackend->getName()) +
+                         " load p50 " + std::to_string(interval.loadPercentile(0.5)) +
+                         "% p99 " + std::to_string(interval.loadPercentile(0.99)) +
+                         "% xruns " + std::to_string(current.xruns());
+        if (samplePack.isOpen()) {
+            audioStatsText += " stream underruns " + std::to_string(synth.getStreamUnderruns());
+        }
+        audioStatsStart = current;
+        audioStatsStartTime = now;
+    }
+    this->fontRenderer->renderText(audioStatsText, 10, 10, 0.4, vec3{1.0, 1.0, 1.0});
+}
+
 void Engine::resetKeyColor(int key) {
     // Determine the original color of the button
     color originalColor = keyVec[key]->getColor();
@@ -10,11 +10,30 @@
 #include "font/fontRenderer.h"
 #include "shapes/rect.h"
 #include "shapes/shape.h"
-#include "portaudio/playSine.h"
-#include "portaudio/soundEngine.h"
+#include "audio/audioBackend.h"
+#include "audio/fileBackend.h"
+#include "audio/timerBackend.h"
+#include "portaudio/portAudioBackend.h"
+#include "synth/synth.h"
+#include "synth/wavReader.h"
 
 using std::vector, std::unique_ptr, std::make_unique, glm::ortho, glm::mat4, glm::vec3, glm::vec4;
 
+/**
+ * @brief Binds a keyboard key to a piano key.
+ *
+ * @param key The GLFW key code that plays the piano key
+ * @param pianoIndex Index of the piano key's shape in the piano vector
+ * @param note The MIDI note the piano key plays
+ * @param black True if the piano key is a black key
+ */
+struct PianoKeyBinding {
+    int key;
+    int pianoIndex;
+    int note;
+    bool black;
+};
+
 /**
  * @brief The Engine class.
  * @details The Engine class is responsible for initializing the GLFW window, loading shaders, and rendering the game state.
@@ -23,7 +42,6 @@ class Engine {
 private:
     std::vector<bool> playSound;
     std::vector<int> pianoKeys;
-    std::vector<float> frequencies;
 
 
     /// @brief The actual GLFW window.
@@ -60,6 +78,30 @@ private:
     double MouseX, MouseY;
     bool mousePressedLastFrame = false;
 
+    /// @brief Whether the audio thread's real-time placement still has to be printed once its first buffer has placed it.
+    bool audioPlacementPending = false;
+
+    /// @brief Whether each key is lit for the demo song, so the song only recolours keys when its notes change.
+    bool songNoteLit[Synth::NUM_NOTES] = {};
+
+    /// @brief The temperament F3 last switched to, and the pitch of A4 it tunes to.
+    /// @details Starts from the tuning the engine was given. A Scala scale has no temperament, so F3 leaves it alone.
+    Temperament temperament = Temperament::Equal;
+    bool temperamentActive = true;
+    double tuningReference = Tuning::DEFAULT_REFERENCE;
+
+    /// @brief Whether the audio callback stats are drawn over every screen (toggled with F1).
+    bool showAudioStats = false;
+    /// @brief The callback stats at the start of the current overlay interval.
+    CallbackSnapshot audioStatsStart;
+    /// @brief glfwGetTime() when audioStatsStart was taken.
+    double audioStatsStartTime = 0;
+    /// @brief The overlay text for the last full interval.
+    string audioStatsText;
+
+    /// @brief Refreshes the overlay text once a second and draws it in the bottom left corner.
+    void renderAudioStats();
+
     /// @note Call glCheckError() after every OpenGL call to check for errors.
     GLenum glCheckError_(const char *file, int line);
     /// @brief Macro for glCheckError_ function. Used for debugging.
@@ -67,18 +109,31 @@ private:
 
 public:
 
-    SoundEngine sound_engine;
+    /// @brief Recorded piano samples the synth plays, if one was given on the command line.
+    /// @details Declared before the synth so it stays mapped until the synth's streamer has stopped.
+    SamplePack samplePack;
 
-    Sine sine;
-    vector<SoundEngine> sounds;
+    /// @brief Mary Had a Little Lamb, which the synth plays at the start of the game.
+    /// @details Declared before the synth, which plays it from the audio callback.
+    Sequence demoSong;
 
-    ScopedPaHandler paInit;
+    /// @brief Polyphonic synth played by the piano keys.
+    Synth synth;
 
-    bool isPlaying;
+    /// @brief Always-running audio output that renders the synth.
+    /// @details Declared after the synth so it stops pulling from the synth before the synth is destroyed.
+    unique_ptr<AudioBackend> audioBackend;
 
     /// @brief Constructor for the Engine class.
-    /// @details Initializes window and shaders.
-    Engine();
+    /// @details Initializes window, audio and shaders.
+    /// @param audioOutput "portaudio" or empty for the default sound card, "null" for no output,
+    /// or a file path (.wav or raw float) to record to
+    /// @param latency The latency profile, buffer size and sample rate to ask the output for
+    /// @param samplePackPath A sample pack to play instead of the wavetables, or empty for none
+    /// @param reverbPath A WAV impulse response to convolve the synth with, "room" for a synthetic room, or empty for none
+    /// @param tuning The keyboard's tuning. If it is a temperament, F3 steps on from it at its A4.
+    explicit Engine(const string &audioOutput = "", const LatencyConfig &latency = LatencyConfig(),
+                    const string &samplePackPath = "", const string &reverbPath = "", const Tuning &tuning = Tuning());
 
     /// @brief Destructor for the Engine class.
     ~Engine();
@@ -87,6 +142,15 @@ public:
     /// @return 0 if successful, -1 otherwise.
     unsigned int initWindow(bool debug = false);
 
+    /// @brief Opens and starts the audio backend. Falls back to a null backend if the output cannot be opened.
+    /// @param audioOutput Which output to use (see Engine())
+    /// @param latency The settings to open it with
+    /// @param samplePackPath A sample pack for the synth to play, or empty for none
+    /// @param reverbPath An impulse response for the synth's reverb (see Engine())
+    /// @param tuning The keyboard's tuning
+    void initAudio(const string &audioOutput, const LatencyConfig &latency, const string &samplePackPath,
+                   const string &reverbPath, const Tuning &tuning);
+
     /// @brief Loads shaders from files and stores them in the shaderManager.
     /// @details Renderers are initialized here.
     void initShaders();
@@ -125,14 +189,6 @@ public:
         // Add other keys as needed...
     }
 
-    // Function to initialize the frequencies vector
-    void initializeFrequencies() {
-        // Add the frequencies associated with each key to the frequencies vector
-        // For example, to add the frequency for GLFW_KEY_Z:
-        frequencies.push_back(261.63f); // C4
-        // Add other frequencies as needed...
-    }
-
 
     // -----------------------------------
     // Getters
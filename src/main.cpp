@@ -1,9 +1,76 @@
 
 #include "engine.h"
+#include <cstdlib>
 #include <iostream>
 
  int main(int argc, char *argv[]) {
-    Engine engine;
+    // --audio portaudio|null|<file> picks where the synth plays
+    // --latency ultra-low|low|safe, --frames <n> and --rate <hz> tune the output for this machine
+    // --format float32|int24|int16 picks the sample format to ask the sound card for first
+    // --samples <pack> plays a sample pack made by buildSamplePack
+    // --reverb <ir.wav|room> convolves the synth with an impulse response
+    // --tuning <temperament|scale.scl> and --kbm <mapping.kbm> retune the keyboard, --a4 <hz> sets the pitch it is tuned to
+    // --realtime <priority> runs the audio threads at SCHED_FIFO priority and locks memory; --cores <list> pins them
+    string audioOutput;
+    string samplePackPath;
+    string reverbPath;
+    string tuningName;
+    string mappingPath;
+    double reference = Tuning::DEFAULT_REFERENCE;
+    LatencyConfig latency;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--audio") {
+            audioOutput = argv[i + 1];
+        } else if (arg == "--latency") {
+            if (!LatencyConfig::parseProfile(argv[i + 1], latency.profile)) {
+                std::cerr << "Unknown latency profile '" << argv[i + 1] << "', using low" << std::endl;
+            }
+        } else if (arg == "--frames") {
+            latency.framesPerBuffer = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (arg == "--rate") {
+            latency.sampleRate = std::strtod(argv[i + 1], nullptr);
+        } else if (arg == "--format") {
+            if (!SampleConverter::parseFormat(argv[i + 1], latency.sampleFormat)) {
+                std::cerr << "Unknown sample format '" << argv[i + 1] << "', using float32" << std::endl;
+            }
+        } else if (arg == "--realtime") {
+            latency.realtime.priority = std::atoi(argv[i + 1]);
+            latency.realtime.lockMemory = latency.realtime.priority > 0;
+        } else if (arg == "--cores") {
+            if (!RealtimeOptions::parseCores(argv[i + 1], latency.realtime.cores)) {
+                std::cerr << "Unknown core list '" << argv[i + 1] << "', leaving the threads unpinned" << std::endl;
+            }
+        } else if (arg == "--samples") {
+            samplePackPath = argv[i + 1];
+        } else if (arg == "--reverb") {
+            reverbPath = argv[i + 1];
+        } else if (arg == "--tuning") {
+            tuningName = argv[i + 1];
+        } else if (arg == "--kbm") {
+            mappingPath = argv[i + 1];
+        } else if (arg == "--a4") {
+            reference = std::strtod(argv[i + 1], nullptr);
+            if (reference <= 0.0) {
+                std::cerr << "Bad A4 pitch '" << argv[i + 1] << "', using 440 Hz" << std::endl;
+                reference = Tuning::DEFAULT_REFERENCE;
+            }
+        }
+    }
+
+    // Anything else is read as a Scala file; fall back to equal temperament if it cannot be read
+    Temperament temperament = Temperament::Equal;
+    Tuning tuning = Tuning::fromTemperament(temperament, reference);
+    if (!tuningName.empty() && !Tuning::parseTemperament(tuningName, temperament)) {
+        string error;
+        if (!Tuning::loadScala(tuningName, mappingPath, reference, tuning, error)) {
+            std::cerr << "Could not read scale " << tuningName << ": " << error << std::endl;
+        }
+    } else {
+        tuning = Tuning::fromTemperament(temperament, reference);
+    }
+
+    Engine engine(audioOutput, latency, samplePackPath, reverbPath, tuning);
 
     while (!engine.shouldClose()) {
         engine.processInput();
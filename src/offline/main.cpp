@@ -0,0 +1,166 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "offlineRenderer.h"
+
+namespace fs = std::filesystem;
+using std::cout, std::cerr, std::endl, std::string, std::vector;
+
+namespace {
+
+void printUsage() {
+    cout << "Usage: offlineRender [-j threads] [-o output_dir] [-w sine|saw|square|piano] [-r rate] <file.mid | directory>..." << endl
+         << "Renders MIDI files to 16-bit stereo WAV files without an audio device." << endl
+         << "Renders at 44100 Hz unless -r gives another rate." << endl
+         << "Directories are searched for .mid and .midi files. Files are spread across the worker threads." << endl;
+}
+
+bool parseWaveform(const string &name, Waveform &waveform) {
+    if (name == "sine") waveform = Waveform::Sine;
+    else if (name == "saw") waveform = Waveform::Saw;
+    else if (name == "square") waveform = Waveform::Square;
+    else if (name == "piano") waveform = Waveform::Piano;
+    else return false;
+    return true;
+}
+
+bool isMidiFile(const fs::path &path) {
+    string extension = path.extension().string();
+    return extension == ".mid" || extension == ".midi" || extension == ".MID" || extension == ".MIDI";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    unsigned int threadCount = std::thread::hardware_concurrency();
+    fs::path outputDir;
+    Waveform waveform = Waveform::Piano;
+    double sampleRate = Synth::DEFAULT_SAMPLE_RATE;
+    vector<fs::path> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (arg == "-j" && i + 1 < argc) {
+            char *end = nullptr;
+            unsigned long count = std::strtoul(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || count == 0 || count > 1024) {
+                cerr << "ERROR::RENDER: Bad thread count " << argv[i] << endl;
+                return 1;
+            }
+            threadCount = (unsigned int)count;
+        } else if (arg == "-o" && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else if (arg == "-w" && i + 1 < argc) {
+            if (!parseWaveform(argv[++i], waveform)) {
+                cerr << "ERROR::RENDER: Unknown waveform " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "-r" && i + 1 < argc) {
+            sampleRate = std::strtod(argv[++i], nullptr);
+            if (sampleRate < 8000.0 || sampleRate > 192000.0) {
+                cerr << "ERROR::RENDER: Unsupported sample rate " << argv[i] << endl;
+                return 1;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            printUsage();
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    // Expand directories into the MIDI files they contain
+    vector<fs::path> files;
+    for (const fs::path &input : inputs) {
+        std::error_code error;
+        if (fs::is_directory(input, error)) {
+            for (const fs::directory_entry &entry : fs::recursive_directory_iterator(input, error)) {
+                if (entry.is_regular_file() && isMidiFile(entry.path())) {
+                    files.push_back(entry.path());
+                }
+            }
+        } else {
+            files.push_back(input);
+        }
+    }
+    if (files.empty()) {
+        printUsage();
+        return 1;
+    }
+    if (!outputDir.empty()) {
+        fs::create_directories(outputDir);
+    }
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    if (threadCount > files.size()) {
+        threadCount = (unsigned int)files.size();
+    }
+
+    // Built once before the workers start, then only read
+    const WavetableBank &bank = WavetableBank::shared();
+
+    std::atomic<size_t> nextFile{0};
+    std::atomic<int> failures{0};
+    std::mutex printMutex;
+    double totalAudioSeconds = 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Each worker takes the next unrendered file until none are left
+    auto worker = [&]() {
+        OfflineRenderer renderer(bank, waveform, sampleRate);
+        for (size_t index = nextFile++; index < files.size(); index = nextFile++) {
+            const fs::path &file = files[index];
+            fs::path output = file;
+            output.replace_extension(".wav");
+            if (!outputDir.empty()) {
+                output = outputDir / output.filename();
+            }
+
+            vector<MidiEvent> events;
+            string error;
+            RenderStats stats;
+            bool ok = MidiFile::load(file.string(), events, error);
+            if (ok && !renderer.render(events, output.string(), stats)) {
+                ok = false;
+                error = "could not write " + output.string();
+            }
+
+            std::lock_guard<std::mutex> lock(printMutex);
+            if (ok) {
+                totalAudioSeconds += stats.audioSeconds;
+                cout << file.string() << " -> " << output.string() << " (" << stats.audioSeconds << " s audio in "
+                     << stats.wallSeconds << " s, " << stats.audioSeconds / stats.wallSeconds << "x real time)" << endl;
+            } else {
+                failures++;
+                cerr << "ERROR::RENDER: " << file.string() << ": " << error << endl;
+            }
+        }
+    };
+
+    vector<std::thread> workers;
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.emplace_back(worker);
+    }
+    for (std::thread &thread : workers) {
+        thread.join();
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cout << "Rendered " << files.size() - failures << " of " << files.size() << " files on " << threadCount
+         << " threads (" << selectRenderKernel().name << " kernel): " << totalAudioSeconds << " s audio in "
+         << wallSeconds << " s, " << totalAudioSeconds / wallSeconds << "x real time" << endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+#include "offlineRenderer.h"
+
+#include <chrono>
+#include <memory>
+
+#include "../synth/denormals.h"
+#include "../synth/synth.h"
+#include "../synth/wavWriter.h"
+
+namespace {
+
+/// @brief Synth::render() treats time 0 as "no timestamp", so the offline clock starts here instead.
+constexpr double CLOCK_START = 1.0;
+
+/// @brief General MIDI puts drums on channel 10, which a piano should not play.
+constexpr int DRUM_CHANNEL = 9;
+
+/// @brief A block whose peak is under half a 16-bit step writes nothing but dither, so the tail can stop there.
+constexpr float SILENCE = 1.0f / 65536.0f;
+
+float peak(const float *samples, unsigned long count) {
+    float peak = 0.0f;
+    for (unsigned long i = 0; i < count; i++) {
+        float magnitude = samples[i] < 0.0f ? -samples[i] : samples[i];
+        peak = magnitude > peak ? magnitude : peak;
+    }
+    return peak;
+}
+
+} // namespace
+
+OfflineRenderer::OfflineRenderer(const WavetableBank &bank, Waveform waveform, double sampleRate)
+        : bank(bank), waveform(waveform), sampleRate(sampleRate) {}
+
+bool OfflineRenderer::render(const std::vector<MidiEvent> &events, const std::string &outputPath, RenderStats &stats) {
+    auto start = std::chrono::steady_clock::now();
+    ScopedFlushToZero flushToZero;
+
+    // The synth's voice pool is too large to keep on the stack
+    std::unique_ptr<Synth> synth = std::make_unique<Synth>(bank, selectRenderKernel());
+    synth->setWaveform(waveform);
+    synth->setSampleRate(sampleRate);
+
+    WavWriter writer;
+    if (!writer.open(outputPath, (int)sampleRate, 2)) {
+        return false;
+    }
+
+    float buffer[BLOCK_FRAMES * 2];
+    unsigned long framesRendered = 0;
+    size_t next = 0;
+    double lastEventTime = events.empty() ? 0.0 : events.back().time;
+    bool released = false;
+    // The limiter's delay and the reverb still sound after the last voice stops; render on until they fall silent
+    bool sounding = true;
+    unsigned long tailFrames = 0;
+    const unsigned long maxTailFrames = (unsigned long)(MAX_TAIL_SECONDS * sampleRate);
+
+    while (next < events.size() || synth->getActiveVoiceCount() > 0 || (sounding && tailFrames < maxTailFrames)) {
+        double bufferTime = CLOCK_START + framesRendered / sampleRate;
+        double bufferEnd = bufferTime + BLOCK_FRAMES / sampleRate;
+
+        // Queue everything due in this block. Anything that does not fit goes out with the next one.
+        while (next < events.size() && CLOCK_START + events[next].time < bufferEnd) {
+            const MidiEvent &event = events[next];
+            if (event.channel != DRUM_CHANNEL) {
+                double time = CLOCK_START + event.time;
+                bool queued;
+                if (event.type == NoteEvent::NoteOn) {
+                    queued = synth->noteOn(event.note, time, event.velocity);
+                } else if (event.type == NoteEvent::NoteOff) {
+                    queued = synth->noteOff(event.note, time);
+                } else {
+                    queued = synth->setSustain(event.type == NoteEvent::SustainOn, time);
+                }
+                if (!queued) {
+                    break;
+                }
+            }
+            next++;
+        }
+
+        // Stop notes that were never released
+        if (!released && next == events.size() && bufferTime - CLOCK_START > lastEventTime + MAX_TAIL_SECONDS) {
+            synth->allNotesOff();
+            released = true;
+        }
+
+        bool voicesActive = synth->getActiveVoiceCount() > 0;
+        synth->render(buffer, BLOCK_FRAMES, bufferTime);
+        if (!writer.write(buffer, BLOCK_FRAMES)) {
+            return false;
+        }
+        sounding = peak(buffer, BLOCK_FRAMES * 2) >= SILENCE;
+        tailFrames = voicesActive || next < events.size() ? 0 : tailFrames + BLOCK_FRAMES;
+        framesRendered += BLOCK_FRAMES;
+    }
+
+    bool ok = writer.close();
+    stats.audioSeconds = framesRendered / sampleRate;
+    stats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ok;
+}
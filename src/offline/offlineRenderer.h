@@ -0,0 +1,54 @@
+#ifndef GRAPHICS_OFFLINERENDERER_H
+#define GRAPHICS_OFFLINERENDERER_H
+
+#include <string>
+#include <vector>
+
+#include "../synth/midiFile.h"
+#include "../synth/synth.h"
+
+/**
+ * @brief How long a render took.
+ *
+ * @param audioSeconds The length of the rendered audio
+ * @param wallSeconds The time spent rendering and writing it
+ */
+struct RenderStats {
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+};
+
+/**
+ * @brief Renders note events through a Synth straight to a WAV file, as fast as the CPU allows.
+ * @details No audio device is involved. Each renderer owns its own Synth, so several can run on
+ * different threads while sharing one read-only WavetableBank.
+ */
+class OfflineRenderer {
+public:
+    /// @brief The number of frames rendered per Synth::render() call.
+    static constexpr unsigned long BLOCK_FRAMES = 256;
+
+    /// @brief How long held notes may ring past the last event before they are released, and the longest the
+    /// limiter and reverb may sound on after the last voice stops.
+    static constexpr double MAX_TAIL_SECONDS = 10.0;
+
+    /// @brief Construct a new OfflineRenderer object
+    /// @param bank The wavetables to play. Must outlive the renderer.
+    /// @param waveform The waveform every note uses
+    /// @param sampleRate The rate to render and write at
+    OfflineRenderer(const WavetableBank &bank, Waveform waveform, double sampleRate = Synth::DEFAULT_SAMPLE_RATE);
+
+    /// @brief Renders events, then lets every voice and the reverb ring out, writing the result to a stereo WAV file.
+    /// @param events Note events sorted by time
+    /// @param outputPath The WAV file to write
+    /// @param stats Receives the rendered length and the time it took
+    /// @return false if the output file could not be written
+    bool render(const std::vector<MidiEvent> &events, const std::string &outputPath, RenderStats &stats);
+
+private:
+    const WavetableBank &bank;
+    Waveform waveform;
+    double sampleRate;
+};
+
+#endif //GRAPHICS_OFFLINERENDERER_H
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../synth/sampleCodec.h"
+#include "../synth/samplePack.h"
+#include "../synth/wavReader.h"
+
+namespace fs = std::filesystem;
+using std::cout, std::cerr, std::endl, std::string, std::vector;
+
+namespace {
+
+void printUsage() {
+    cout << "Usage: buildSamplePack [-c] -o <pack.spk> <directory | pack.spk>" << endl
+         << "       buildSamplePack --benchmark <pack.spk>" << endl
+         << "Packs WAV files named <note>v<velocity>.wav (e.g. 60v64.wav) into one sample pack." << endl
+         << "<note> is the MIDI note the sample was recorded at and <velocity> the highest velocity its layer plays for." << endl
+         << "A file named <note>.wav covers every velocity. Each note's samples play for the keys nearest to it." << endl
+         << "Given a pack instead of a directory, rewrites it, which converts between float and compressed packs." << endl
+         << "  -c           compress the samples (lossless for 16 and 24-bit recordings)" << endl
+         << "  --benchmark  measure how fast a pack's samples decode" << endl;
+}
+
+/// @brief Reads the root note and top velocity out of a file name like "60v64".
+bool parseName(const string &stem, int &note, int &velocity) {
+    size_t split = stem.find('v');
+    try {
+        size_t used;
+        note = std::stoi(stem.substr(0, split), &used);
+        if (used != (split == string::npos ? stem.size() : split)) {
+            return false;
+        }
+        velocity = split == string::npos ? 127 : std::stoi(stem.substr(split + 1));
+    } catch (const std::exception &) {
+        return false;
+    }
+    return note >= 0 && note < 128 && velocity >= 1 && velocity <= 127;
+}
+
+/// @brief Reads WAV files named after their root note and layer into pack entries.
+bool loadDirectory(const fs::path &input, vector<SamplePackEntry> &entries, int &sampleRate) {
+    // Root note -> (top velocity -> samples)
+    std::map<int, std::map<int, vector<float>>> layers;
+    sampleRate = 0;
+    std::error_code error;
+    for (const fs::directory_entry &entry : fs::directory_iterator(input, error)) {
+        string extension = entry.path().extension().string();
+        if (!entry.is_regular_file() || (extension != ".wav" && extension != ".WAV")) {
+            continue;
+        }
+        int note, velocity;
+        if (!parseName(entry.path().stem().string(), note, velocity)) {
+            cerr << "Skipping " << entry.path().filename().string() << ": name is not <note>v<velocity>" << endl;
+            continue;
+        }
+
+        vector<float> samples;
+        int rate;
+        string readError;
+        if (!WavReader::loadMono(entry.path().string(), samples, rate, readError)) {
+            cerr << "ERROR::PACK: " << entry.path().string() << ": " << readError << endl;
+            return false;
+        }
+        if (sampleRate != 0 && rate != sampleRate) {
+            cerr << "ERROR::PACK: " << entry.path().string() << " is " << rate << " Hz, the others are "
+                 << sampleRate << " Hz" << endl;
+            return false;
+        }
+        sampleRate = rate;
+        layers[note][velocity] = std::move(samples);
+    }
+    if (error || layers.empty()) {
+        cerr << "ERROR::PACK: No samples found in " << input.string() << endl;
+        return false;
+    }
+
+    // Each root covers the keys up to halfway to its neighbours, and each layer the velocities above the one below it
+    vector<int> roots;
+    for (const auto &root : layers) {
+        roots.push_back(root.first);
+    }
+    for (size_t i = 0; i < roots.size(); i++) {
+        int lowNote = i == 0 ? 0 : (roots[i - 1] + roots[i]) / 2 + 1;
+        int highNote = i + 1 == roots.size() ? 127 : (roots[i] + roots[i + 1]) / 2;
+        int lowVelocity = 0;
+        for (auto &layer : layers[roots[i]]) {
+            // The loudest layer also covers anything above its stated velocity
+            bool loudest = layer.first == layers[roots[i]].rbegin()->first;
+            entries.push_back(SamplePackEntry{roots[i], lowNote, highNote, lowVelocity, loudest ? 127 : layer.first,
+                                              std::move(layer.second)});
+            lowVelocity = layer.first + 1;
+        }
+    }
+    return true;
+}
+
+/// @brief Decodes every zone of an existing pack into pack entries.
+bool loadPack(const string &path, vector<SamplePackEntry> &entries, int &sampleRate) {
+    SamplePack pack;
+    string error;
+    if (!pack.open(path, error)) {
+        cerr << "ERROR::PACK: " << path << ": " << error << endl;
+        return false;
+    }
+    sampleRate = (int)pack.getSampleRate();
+    for (size_t i = 0; i < pack.getZoneCount(); i++) {
+        const SampleZone &zone = pack.getZone(i);
+        SamplePackEntry entry{zone.rootNote, zone.lowNote, zone.highNote, zone.lowVelocity, zone.highVelocity,
+                              vector<float>(zone.frames)};
+        pack.readFrames(zone, 0, zone.frames, entry.samples.data());
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+/// @brief Decodes a whole pack block by block and reports throughput and the slowest block.
+int benchmark(const string &path) {
+    SamplePack pack;
+    string error;
+    if (!pack.open(path, error)) {
+        cerr << "ERROR::PACK: " << path << ": " << error << endl;
+        return 1;
+    }
+
+    const int passes = 5;
+    const uint64_t blockFrames = SampleCodec::BLOCK_FRAMES;
+    vector<float> block(blockFrames);
+    uint64_t frames = 0;
+    double seconds = 0.0, slowest = 0.0;
+    // The first pass pulls the file into the page cache and is not timed
+    for (int pass = 0; pass <= passes; pass++) {
+        for (size_t i = 0; i < pack.getZoneCount(); i++) {
+            const SampleZone &zone = pack.getZone(i);
+            for (uint64_t first = 0; first < zone.frames; first += blockFrames) {
+                uint64_t count = zone.frames - first < blockFrames ? zone.frames - first : blockFrames;
+                auto start = std::chrono::steady_clock::now();
+                pack.readFrames(zone, first, count, block.data());
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (pass > 0) {
+                    seconds += elapsed;
+                    slowest = std::max(slowest, elapsed);
+                    frames += count;
+                }
+            }
+        }
+    }
+    if (frames == 0 || seconds <= 0.0) {
+        cerr << "ERROR::PACK: " << path << " has no samples" << endl;
+        return 1;
+    }
+
+    std::error_code sizeError;
+    double fileBytes = (double)fs::file_size(path, sizeError);
+    double rawBytes = (double)frames / passes * sizeof(float);
+    cout << "Decoder: " << SampleCodec::getDecoderName() << endl
+         << "Size: " << fileBytes / (1024 * 1024) << " MiB, " << 100.0 * fileBytes / rawBytes << "% of float32" << endl
+         << "Throughput: " << frames / seconds / 1e6 << " Msamples/s (" << frames / seconds / pack.getSampleRate()
+         << "x real time per voice), " << seconds / frames * 1e9 << " ns/sample" << endl
+         << "Slowest " << blockFrames << "-sample block: " << slowest * 1e6 << " us" << endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    string output;
+    fs::path input;
+    SampleEncoding encoding = SampleEncoding::Float32;
+    bool runBenchmark = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "-c") {
+            encoding = SampleEncoding::Rice24;
+        } else if (arg == "--benchmark") {
+            runBenchmark = true;
+        } else if (!arg.empty() && arg[0] != '-' && input.empty()) {
+            input = arg;
+        } else {
+            printUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if (runBenchmark && !input.empty()) {
+        return benchmark(input.string());
+    }
+    if (output.empty() || input.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    vector<SamplePackEntry> entries;
+    int sampleRate;
+    std::error_code error;
+    bool loaded = fs::is_directory(input, error) ? loadDirectory(input, entries, sampleRate)
+                                                 : loadPack(input.string(), entries, sampleRate);
+    if (!loaded) {
+        return 1;
+    }
+
+    string writeError;
+    if (!SamplePack::write(output, sampleRate, entries, encoding, writeError)) {
+        cerr << "ERROR::PACK: " << writeError << endl;
+        return 1;
+    }
+    size_t totalFrames = 0;
+    for (const SamplePackEntry &entry : entries) {
+        totalFrames += entry.samples.size();
+    }
+    cout << "Wrote " << entries.size() << " zones, " << totalFrames / (double)sampleRate << " s of audio at "
+         << sampleRate << " Hz, " << (encoding == SampleEncoding::Rice24 ? "compressed" : "as float") << ", to "
+         << output << endl;
+    return 0;
+}
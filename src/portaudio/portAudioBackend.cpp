@@ -0,0 +1,250 @@
+#include "portAudioBackend.h"
+
+#include <chrono>
+#include <stdio.h>
+
+#include "../synth/denormals.h"
+#include "../synth/realtimeGuard.h"
+
+namespace {
+
+/// @brief Frames rendered at a time before conversion when the stream does not take floats.
+constexpr unsigned long SCRATCH_FRAMES = 512;
+
+/// @brief The PortAudio format for each sample format.
+PaSampleFormat paFormat(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Float32:
+            return paFloat32;
+        case SampleFormat::Int24:
+            return paInt24;
+        case SampleFormat::Int16:
+            return paInt16;
+    }
+    return paFloat32;
+}
+
+/// @brief The latency a profile suggests to the device.
+PaTime suggestedLatency(LatencyProfile profile, const PaDeviceInfo *info, double sampleRate,
+                        unsigned long framesPerBuffer) {
+    switch (profile) {
+        case LatencyProfile::UltraLow:
+            // Two buffers in flight; PortAudio rounds this up to the least the host can do
+            return 2.0 * framesPerBuffer / sampleRate;
+        case LatencyProfile::Low:
+            return info->defaultLowOutputLatency;
+        case LatencyProfile::Safe:
+            return info->defaultHighOutputLatency;
+    }
+    return info->defaultLowOutputLatency;
+}
+
+} // namespace
+
+PortAudioBackend::PortAudioBackend(Synth &synth, const LatencyConfig &latency, PaDeviceIndex device)
+        : synth(synth), latency(latency), device(device), stream(0), scratch(SCRATCH_FRAMES * 2), outputLatency(0) {}
+
+PortAudioBackend::~PortAudioBackend() {
+    close();
+}
+
+bool PortAudioBackend::open() {
+    if (paInit.result() != paNoError) {
+        fprintf(stderr, "An error occurred while initializing portaudio\n");
+        fprintf(stderr, "Error number: %d\n", paInit.result());
+        fprintf(stderr, "Error message: %s\n", Pa_GetErrorText(paInit.result()));
+        return false;
+    }
+
+    PaStreamParameters outputParameters;
+
+    outputParameters.device = (device == paNoDevice) ? Pa_GetDefaultOutputDevice() : device;
+    if (outputParameters.device == paNoDevice) {
+        fprintf(stderr, "No audio output device available\n");
+        return false;
+    }
+
+    const PaDeviceInfo* pInfo = Pa_GetDeviceInfo(outputParameters.device);
+    if (pInfo == 0) {
+        return false;
+    }
+    printf("Output device name: '%s'\n", pInfo->name);
+
+    // Run at the device's own rate unless asked otherwise, so nothing between the synth and the device resamples
+    double sampleRate = latency.sampleRate != 0 ? latency.sampleRate : pInfo->defaultSampleRate;
+    if (sampleRate <= 0) {
+        sampleRate = synth.getSampleRate();
+    }
+
+    outputParameters.channelCount = 2;       /* stereo output */
+    outputParameters.hostApiSpecificStreamInfo = NULL;
+
+    // Step from the configured profile towards Safe. Within each profile, try the requested buffer size
+    // before letting the host choose one.
+    for (int step = (int)latency.profile; step <= (int)LatencyProfile::Safe; step++) {
+        LatencyProfile profile = (LatencyProfile)step;
+        unsigned long requestedFrames = (profile == latency.profile) ? latency.resolvedFramesPerBuffer()
+                                                                     : LatencyConfig::profileFramesPerBuffer(profile);
+        outputParameters.suggestedLatency = suggestedLatency(profile, pInfo, sampleRate, requestedFrames);
+
+        for (unsigned long framesPerBuffer : {requestedFrames, (unsigned long)paFramesPerBufferUnspecified}) {
+            PaError err = tryOpen(outputParameters, sampleRate, framesPerBuffer);
+            if (err != paNoError) {
+                fprintf(stderr, "Device refused %s latency (%.1f ms) with %lu frames per buffer: %s\n",
+                        LatencyConfig::profileName(profile), outputParameters.suggestedLatency * 1000.0,
+                        framesPerBuffer, Pa_GetErrorText(err));
+                continue;
+            }
+
+            const PaStreamInfo* streamInfo = Pa_GetStreamInfo(stream);
+            outputLatency = streamInfo != 0 ? streamInfo->outputLatency : 0;
+
+            format.sampleRate = streamInfo != 0 ? streamInfo->sampleRate : sampleRate;
+            // The stream has not started, so the synth can still be retuned
+            synth.setSampleRate(format.sampleRate);
+            format.framesPerBuffer = framesPerBuffer;
+            format.outputLatency = outputLatency;
+            format.sampleFormat = converter.getFormat();
+            if (profile != latency.profile) {
+                printf("Fell back to %s latency\n", LatencyConfig::profileName(profile));
+            }
+            return true;
+        }
+    }
+
+    fprintf(stderr, "Failed to open audio stream at any latency\n");
+    return false;
+}
+
+PaError PortAudioBackend::tryOpen(PaStreamParameters &outputParameters, double sampleRate,
+                                  unsigned long framesPerBuffer) {
+    const SampleFormat formats[] = {latency.sampleFormat, SampleFormat::Float32, SampleFormat::Int24, SampleFormat::Int16};
+    PaError err = paSampleFormatNotSupported;
+    for (int i = 0; i < 4; i++) {
+        const SampleFormat sampleFormat = formats[i];
+        if (i > 0 && sampleFormat == latency.sampleFormat) {
+            continue; // already tried first
+        }
+        outputParameters.sampleFormat = paFormat(sampleFormat);
+
+        // Ask first so a refused format is not half-opened on hosts that are slow to fail
+        err = Pa_IsFormatSupported(NULL, &outputParameters, sampleRate);
+        if (err != paFormatIsSupported) {
+            continue;
+        }
+
+        err = Pa_OpenStream(
+                &stream,
+                NULL, /* no input */
+                &outputParameters,
+                sampleRate,
+                framesPerBuffer,
+                paClipOff | paDitherOff, /* the converter clips and dithers, so PortAudio need not */
+                &PortAudioBackend::paCallback,
+                this            /* Using 'this' for userData so we can cast to PortAudioBackend* in paCallback */
+        );
+        if (err == paNoError) {
+            converter = SampleConverter(sampleFormat);
+            return paNoError;
+        }
+        stream = 0;
+    }
+    return err;
+}
+
+bool PortAudioBackend::close() {
+    if (stream == 0)
+        return false;
+
+    PaError err = Pa_CloseStream(stream);
+    stream = 0;
+    return (err == paNoError);
+}
+
+bool PortAudioBackend::start() {
+    if (stream == 0)
+        return false;
+
+    PaError err = Pa_StartStream(stream);
+    return (err == paNoError);
+}
+
+bool PortAudioBackend::stop() {
+    if (stream == 0)
+        return false;
+
+    PaError err = Pa_StopStream(stream);
+    return (err == paNoError);
+}
+
+double PortAudioBackend::time() const {
+    if (stream == 0)
+        return 0;
+
+    return Pa_GetStreamTime(stream);
+}
+
+const char *PortAudioBackend::getName() const {
+    return "portaudio";
+}
+
+int PortAudioBackend::paCallbackMethod(const void *inputBuffer, void *outputBuffer,
+                                       unsigned long framesPerBuffer,
+                                       const PaStreamCallbackTimeInfo* timeInfo,
+                                       PaStreamCallbackFlags statusFlags) {
+    (void) inputBuffer; /* Prevent unused variable warnings. */
+
+    // Decaying voices and reverb tails must not drop into slow denormal math
+    ScopedFlushToZero flushToZero;
+    // Nothing from here to the return may touch the heap; debug builds abort if it does
+    ScopedRealtimeThread realtime;
+    placeRenderThread();
+
+    auto callbackStart = std::chrono::steady_clock::now();
+
+    if (statusFlags & paOutputUnderflow) {
+        callbackStats.recordUnderflow();
+    }
+    if (statusFlags & paOutputOverflow) {
+        callbackStats.recordOverflow();
+    }
+
+    // Events are stamped with the stream time when the key changed. Mapping the buffer's DAC time back by the
+    // output latency gives roughly now, when everything stamped so far is already past; one more period back is
+    // the start of the period those events came in, so each lands at its offset inside this buffer. Some host
+    // APIs report no DAC time.
+    double bufferTime = 0.0;
+    if (timeInfo != 0 && timeInfo->outputBufferDacTime > 0) {
+        bufferTime = timeInfo->outputBufferDacTime - outputLatency - framesPerBuffer / synth.getSampleRate();
+    }
+
+    if (converter.getFormat() == SampleFormat::Float32) {
+        synth.render((float*)outputBuffer, framesPerBuffer, bufferTime);
+        converter.convert((float*)outputBuffer, outputBuffer, framesPerBuffer * 2);
+    } else {
+        // Render through the scratch buffer in pieces, since the host may pick any buffer size
+        unsigned char *out = (unsigned char*)outputBuffer;
+        const unsigned long frameBytes = 2 * SampleConverter::bytesPerSample(converter.getFormat());
+        for (unsigned long done = 0; done < framesPerBuffer; ) {
+            unsigned long frames = framesPerBuffer - done < SCRATCH_FRAMES ? framesPerBuffer - done : SCRATCH_FRAMES;
+            synth.render(scratch.data(), frames, bufferTime > 0.0 ? bufferTime + done / synth.getSampleRate() : 0.0);
+            converter.convert(scratch.data(), out + done * frameBytes, frames * 2);
+            done += frames;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - callbackStart).count();
+    callbackStats.recordCallback(seconds, framesPerBuffer / synth.getSampleRate());
+    return paContinue;
+}
+
+int PortAudioBackend::paCallback(const void *inputBuffer, void *outputBuffer,
+                                 unsigned long framesPerBuffer,
+                                 const PaStreamCallbackTimeInfo* timeInfo,
+                                 PaStreamCallbackFlags statusFlags,
+                                 void *userData) {
+    return ((PortAudioBackend*)userData)->paCallbackMethod(inputBuffer, outputBuffer,
+                                                           framesPerBuffer,
+                                                           timeInfo,
+                                                           statusFlags);
+}
@@ -0,0 +1,86 @@
+#ifndef GRAPHICS_PORTAUDIOBACKEND_H
+#define GRAPHICS_PORTAUDIOBACKEND_H
+
+#include "portaudio.h"
+#include "scopedPaHandler.h"
+#include "../audio/audioBackend.h"
+#include "../audio/sampleConverter.h"
+
+#include <vector>
+
+/**
+ * @brief An AudioBackend that plays the synth on a PortAudio output device.
+ * @details PortAudio is initialized for as long as the backend exists. The stream is opened and
+ * started once and keeps running until it is closed. Notes are started and stopped through the
+ * Synth, never by starting or stopping the stream.
+ */
+class PortAudioBackend : public AudioBackend {
+public:
+    /// @brief Construct a new PortAudioBackend object
+    /// @param synth The synth rendered by the stream's callback
+    /// @param latency The profile, buffer size and sample rate to ask the device for
+    /// @param device The device to open, or paNoDevice for the default output device
+    explicit PortAudioBackend(Synth &synth, const LatencyConfig &latency = LatencyConfig(),
+                              PaDeviceIndex device = paNoDevice);
+
+    /// @brief Destroy the PortAudioBackend object and close the stream if it is open
+    ~PortAudioBackend() override;
+
+    /// @brief Opens a stereo output stream on the device.
+    /// @details Tries the configured profile and buffer size first. Each time the device refuses, it lets the host
+    /// pick the buffer size, then steps to the next safer profile. At each step the configured sample format is
+    /// offered first, then float, 24-bit and 16-bit. The format that opened is kept in getFormat(), with the
+    /// latency PortAudio reports for the stream.
+    /// @return false if PortAudio failed to initialize, there is no output device, or the device refused every setting
+    bool open() override;
+
+    bool close() override;
+    bool start() override;
+    bool stop() override;
+
+    /// @brief The stream's current time, on the same clock as the callback's time info.
+    /// @return the time in seconds, or 0 if the stream is not open
+    double time() const override;
+
+    const char *getName() const override;
+
+private:
+    /// @brief The instance callback, where we have access to the synth
+    int paCallbackMethod(const void *inputBuffer, void *outputBuffer,
+                         unsigned long framesPerBuffer,
+                         const PaStreamCallbackTimeInfo* timeInfo,
+                         PaStreamCallbackFlags statusFlags);
+
+    /// @brief Tries to open the stream with one buffer size and suggested latency, in each sample format in turn.
+    /// @return paNoError, or why the device refused the last format
+    PaError tryOpen(PaStreamParameters &outputParameters, double sampleRate, unsigned long framesPerBuffer);
+
+    /// @brief Called by PortAudio whenever it needs more audio data.
+    /// @details userData is the PortAudioBackend that opened the stream.
+    static int paCallback(const void *inputBuffer, void *outputBuffer,
+                          unsigned long framesPerBuffer,
+                          const PaStreamCallbackTimeInfo* timeInfo,
+                          PaStreamCallbackFlags statusFlags,
+                          void *userData);
+
+    /// @brief Initializes PortAudio. Declared first so it is terminated after the stream closes.
+    ScopedPaHandler paInit;
+
+    Synth &synth;
+    LatencyConfig latency;
+    PaDeviceIndex device;
+    PaStream *stream;
+
+    /// @brief Clips, dithers and packs the synth's output into the format the stream opened with.
+    SampleConverter converter;
+
+    /// @brief Where the synth renders before conversion when the stream does not take floats.
+    std::vector<float> scratch;
+
+    /// @brief How far ahead of the stream clock the DAC plays, from Pa_GetStreamInfo.
+    /// @details Subtracted from each buffer's DAC time, along with one buffer period, so key presses keep their
+    /// spacing, delayed by this latency plus a period.
+    PaTime outputLatency;
+};
+
+#endif //GRAPHICS_PORTAUDIOBACKEND_H
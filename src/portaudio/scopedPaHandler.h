@@ -0,0 +1,24 @@
+#ifndef GRAPHICS_SCOPEDPAHANDLER_H
+#define GRAPHICS_SCOPEDPAHANDLER_H
+
+#include "portaudio.h"
+
+/// @brief Initializes PortAudio on construction and terminates it on destruction.
+class ScopedPaHandler {
+public:
+    ScopedPaHandler()
+            : _result(Pa_Initialize()) {
+    }
+    ~ScopedPaHandler() {
+        if (_result == paNoError) {
+            Pa_Terminate();
+        }
+    }
+
+    PaError result() const { return _result; }
+
+private:
+    PaError _result;
+};
+
+#endif //GRAPHICS_SCOPEDPAHANDLER_H
@@ -0,0 +1,236 @@
+#include "convolver.h"
+
+#include <new>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SYNTH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// @brief The short partitions a response needs, or 0 if the direct head covers it all.
+int headPartitions(int length) {
+    if (length <= PartitionedConvolver::HEAD_TAPS) {
+        return 0;
+    }
+    int end = length < PartitionedConvolver::TAIL_START ? length : PartitionedConvolver::TAIL_START;
+    return (end - PartitionedConvolver::HEAD_TAPS + PartitionedConvolver::HEAD_TAPS - 1) / PartitionedConvolver::HEAD_TAPS;
+}
+
+/// @brief The long partitions a response needs, or 0 if it ends before TAIL_START.
+int tailPartitions(int length) {
+    if (length <= PartitionedConvolver::TAIL_START) {
+        return 0;
+    }
+    return (length - PartitionedConvolver::TAIL_START + PartitionedConvolver::TAIL_PARTITION - 1) / PartitionedConvolver::TAIL_PARTITION;
+}
+
+}
+
+PartitionedConvolver::Level::Level(int partitionSize, int partitions, RealtimeArena &arena)
+        : partitionSize(partitionSize), partitions(partitions), bins(partitionSize + 1), fft(2 * partitionSize, arena),
+          filterRe(arena.allocate<float>(partitions * bins)), filterIm(arena.allocate<float>(partitions * bins)),
+          inputRe(arena.allocate<float>(partitions * bins)), inputIm(arena.allocate<float>(partitions * bins)),
+          window(arena.allocate<float>(2 * partitionSize)), sumRe(arena.allocate<float>(bins)),
+          sumIm(arena.allocate<float>(bins)), scratch(arena.allocate<float>(2 * partitionSize)),
+          output(arena.allocate<float>(partitionSize)) {}
+
+size_t PartitionedConvolver::Level::arenaBytes(int partitionSize, int partitions) {
+    if (partitions == 0) {
+        return 0;
+    }
+    int bins = partitionSize + 1;
+    return RealtimeArena::bytesFor<Level>(1) + RealFft::arenaBytes(2 * partitionSize) + 4 * RealtimeArena::bytesFor<float>(partitions * bins) + 2 * RealtimeArena::bytesFor<float>(2 * partitionSize)
+           + 2 * RealtimeArena::bytesFor<float>(bins) + RealtimeArena::bytesFor<float>(partitionSize);
+}
+
+void PartitionedConvolver::Level::reset() {
+    newestInput = 0;
+    memset(inputRe, 0, partitions * bins * sizeof(float));
+    memset(inputIm, 0, partitions * bins * sizeof(float));
+    memset(window, 0, 2 * partitionSize * sizeof(float));
+    memset(sumRe, 0, bins * sizeof(float));
+    memset(sumIm, 0, bins * sizeof(float));
+    memset(output, 0, partitionSize * sizeof(float));
+}
+
+void PartitionedConvolver::Level::setFilter(int partition, const float *taps, int count) {
+    // Overlap-save: the partition fills the first half of the transform, the second half stays zero
+    for (int i = 0; i < 2 * partitionSize; i++) {
+        scratch[i] = i < count ? taps[i] : 0.0f;
+    }
+    fft.forward(scratch, &filterRe[partition * bins], &filterIm[partition * bins]);
+}
+
+void PartitionedConvolver::Level::pushInput(const float *windowData) {
+    newestInput = (newestInput + 1) % partitions;
+    fft.forward(windowData, &inputRe[newestInput * bins], &inputIm[newestInput * bins]);
+}
+
+void PartitionedConvolver::Level::accumulate(int first, int last) {
+    float *__restrict accRe = sumRe;
+    float *__restrict accIm = sumIm;
+    for (int partition = first; partition < last; partition++) {
+        int input = (newestInput - partition + partitions) % partitions;
+        const float *__restrict xr = &inputRe[input * bins];
+        const float *__restrict xi = &inputIm[input * bins];
+        const float *__restrict hr = &filterRe[partition * bins];
+        const float *__restrict hi = &filterIm[partition * bins];
+        // Split arrays keep this loop free of shuffles, so it vectorizes as is
+        for (int k = 0; k < bins; k++) {
+            accRe[k] += xr[k] * hr[k] - xi[k] * hi[k];
+            accIm[k] += xr[k] * hi[k] + xi[k] * hr[k];
+        }
+    }
+}
+
+void PartitionedConvolver::Level::finish(float *out) {
+    fft.inverse(sumRe, sumIm, scratch);
+    // The first half wrapped around and is discarded
+    memcpy(out, scratch + partitionSize, partitionSize * sizeof(float));
+    memset(sumRe, 0, bins * sizeof(float));
+    memset(sumIm, 0, bins * sizeof(float));
+}
+
+PartitionedConvolver::PartitionedConvolver(const std::vector<float> &impulseResponse)
+        : length((int)impulseResponse.size()), arena(arenaBytes(length)),
+          head(makeLevel(HEAD_TAPS, headPartitions(length))), tail(makeLevel(TAIL_PARTITION, tailPartitions(length))),
+          tailWindow(arena.allocate<float>(2 * TAIL_PARTITION)), nextTailOutput(arena.allocate<float>(TAIL_PARTITION)) {
+    const float *taps = impulseResponse.data();
+    for (int i = 0; i < HEAD_TAPS; i++) {
+        headTaps[HEAD_TAPS - 1 - i] = i < length ? taps[i] : 0.0f;
+    }
+
+    if (head) {
+        int end = length < TAIL_START ? length : TAIL_START;
+        for (int partition = 0; partition < head->partitions; partition++) {
+            int start = HEAD_TAPS * (partition + 1);
+            head->setFilter(partition, taps + start, end - start < HEAD_TAPS ? end - start : HEAD_TAPS);
+        }
+    }
+
+    if (tail) {
+        for (int partition = 0; partition < tail->partitions; partition++) {
+            int start = TAIL_START + TAIL_PARTITION * partition;
+            tail->setFilter(partition, taps + start, length - start < TAIL_PARTITION ? length - start : TAIL_PARTITION);
+        }
+    }
+
+    reset();
+}
+
+PartitionedConvolver::Level *PartitionedConvolver::makeLevel(int partitionSize, int partitions) {
+    if (partitions == 0) {
+        return nullptr;
+    }
+    // Level holds only numbers and pointers into the arena, so it is never destroyed; it goes with the block
+    return new (arena.allocate<Level>(1)) Level(partitionSize, partitions, arena);
+}
+
+size_t PartitionedConvolver::arenaBytes(int length) {
+    return Level::arenaBytes(HEAD_TAPS, headPartitions(length)) + Level::arenaBytes(TAIL_PARTITION, tailPartitions(length))
+           + RealtimeArena::bytesFor<float>(2 * TAIL_PARTITION) + RealtimeArena::bytesFor<float>(TAIL_PARTITION);
+}
+
+int PartitionedConvolver::getLength() const {
+    return length;
+}
+
+void PartitionedConvolver::reset() {
+    memset(history, 0, sizeof(history));
+    historyIndex = 0;
+    headPosition = 0;
+    tailBlock = 0;
+    for (Level *level : {head, tail}) {
+        if (level != nullptr) {
+            level->reset();
+        }
+    }
+    memset(tailWindow, 0, 2 * TAIL_PARTITION * sizeof(float));
+    memset(nextTailOutput, 0, TAIL_PARTITION * sizeof(float));
+}
+
+float PartitionedConvolver::directHead() const {
+    const float *window = history + historyIndex + 1;
+#ifdef SYNTH_X86
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    for (int i = 0; i < HEAD_TAPS; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_load_ps(headTaps + i), _mm_loadu_ps(window + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_load_ps(headTaps + i + 4), _mm_loadu_ps(window + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(sum0, sum1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    float sum = 0.0f;
+    for (int i = 0; i < HEAD_TAPS; i++) {
+        sum += headTaps[i] * window[i];
+    }
+    return sum;
+#endif
+}
+
+void PartitionedConvolver::process(const float *in, float *out, unsigned long frames) {
+    for (unsigned long i = 0; i < frames; i++) {
+        float sample = in[i];
+        int tailPosition = tailBlock * HEAD_TAPS + headPosition;
+
+        historyIndex = (historyIndex + 1) % HEAD_TAPS;
+        history[historyIndex] = sample;
+        history[historyIndex + HEAD_TAPS] = sample;
+
+        float wet = directHead();
+        if (head) {
+            head->window[HEAD_TAPS + headPosition] = sample;
+            wet += head->output[headPosition];
+        }
+        if (tail) {
+            tail->window[TAIL_PARTITION + tailPosition] = sample;
+            wet += tail->output[tailPosition];
+        }
+        out[i] = wet;
+
+        if (++headPosition == HEAD_TAPS) {
+            endHeadBlock();
+        }
+    }
+}
+
+void PartitionedConvolver::endHeadBlock() {
+    headPosition = 0;
+
+    if (head) {
+        head->pushInput(head->window);
+        head->accumulate(0, head->partitions);
+        head->finish(head->output);
+        memcpy(head->window, head->window + HEAD_TAPS, HEAD_TAPS * sizeof(float));
+    }
+
+    if (tail) {
+        tailStep(tailBlock);
+        if (tailBlock == TAIL_STEPS - 1) {
+            // Freeze the finished long block for the steps of the next one, and start playing the result they built
+            memcpy(tailWindow, tail->window, 2 * TAIL_PARTITION * sizeof(float));
+            memcpy(tail->window, tail->window + TAIL_PARTITION, TAIL_PARTITION * sizeof(float));
+            std::swap(tail->output, nextTailOutput);
+        }
+    }
+
+    tailBlock = (tailBlock + 1) % TAIL_STEPS;
+}
+
+void PartitionedConvolver::tailStep(int step) {
+    // The long block frozen at the last boundary is first needed two long blocks after it ends (its partitions
+    // start TAIL_START taps in), so its work is spread over every small block of the long block in between
+    if (step == 0) {
+        tail->pushInput(tailWindow);
+    } else if (step < TAIL_STEPS - 1) {
+        int shares = TAIL_STEPS - 2;
+        tail->accumulate(tail->partitions * (step - 1) / shares, tail->partitions * step / shares);
+    } else {
+        tail->finish(nextTailOutput);
+    }
+}
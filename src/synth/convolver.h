@@ -0,0 +1,144 @@
+#ifndef GRAPHICS_CONVOLVER_H
+#define GRAPHICS_CONVOLVER_H
+
+#include <vector>
+
+#include "realFft.h"
+#include "realtimeArena.h"
+
+/**
+ * @brief Convolves a signal with a long impulse response with no added latency.
+ * @details The impulse response is split three ways:
+ * - The first HEAD_TAPS taps are applied directly, sample by sample, so the output starts on the input's first sample.
+ * - Taps up to TAIL_START are split into HEAD_TAPS-long partitions convolved in the frequency domain once per HEAD_TAPS block.
+ * - The rest is split into TAIL_PARTITION-long partitions. Their result is only needed two tail blocks later,
+ *   so the forward FFT, the spectrum products and the inverse FFT are spread evenly over the small blocks in between.
+ *
+ * Each small block therefore does the same amount of work however long the impulse response is, and
+ * process() cost per frame stays flat instead of spiking whenever a long partition completes.
+ *
+ * Everything is allocated by the constructor in one arena: the partition levels, their FFT tables and every buffer.
+ * process() never allocates, locks or blocks, and nothing it touches is outside the arena or the object itself.
+ */
+class PartitionedConvolver {
+public:
+    /// @brief Taps applied directly, and the size of the short partitions.
+    static constexpr int HEAD_TAPS = 64;
+
+    /// @brief The size of the long partitions.
+    static constexpr int TAIL_PARTITION = 1024;
+
+    /// @brief Where the long partitions start. The short partitions cover everything before it.
+    static constexpr int TAIL_START = 2 * TAIL_PARTITION;
+
+    /// @param impulseResponse The impulse response to convolve with, at the rate of the signal
+    explicit PartitionedConvolver(const std::vector<float> &impulseResponse);
+
+    /// @brief The length of the impulse response in frames.
+    int getLength() const;
+
+    /// @brief Convolves frames of input into the output. Only the convolved signal is written, not the input.
+    /// @details in and out may be the same buffer.
+    void process(const float *in, float *out, unsigned long frames);
+
+    /// @brief Clears the convolver's history, as if it had only ever been fed silence.
+    void reset();
+
+private:
+    /// @brief The convolution of the last HEAD_TAPS inputs with the head taps.
+    float directHead() const;
+
+    /// @brief Work done at the end of each small block.
+    void endHeadBlock();
+
+    /// @brief One step of the long partitions' work. There are TAIL_STEPS steps per long block.
+    void tailStep(int step);
+
+    static constexpr int TAIL_STEPS = TAIL_PARTITION / HEAD_TAPS;
+
+    int length;
+
+    /// @brief The head taps, reversed so the direct convolution reads the history oldest first.
+    alignas(16) float headTaps[HEAD_TAPS];
+
+    /// @brief The last HEAD_TAPS inputs, stored twice so a window of them is always contiguous.
+    alignas(16) float history[2 * HEAD_TAPS];
+    int historyIndex = 0;
+
+    /// @brief The spectra of one level of partitions and of the input blocks they are multiplied with.
+    struct Level {
+        /// @brief Takes the level's FFT tables and buffers from arena, which needs arenaBytes() free.
+        Level(int partitionSize, int partitions, RealtimeArena &arena);
+
+        /// @brief The arena space a level takes, the level itself included.
+        static size_t arenaBytes(int partitionSize, int partitions);
+
+        /// @brief Zeroes everything but the filter.
+        void reset();
+
+        int partitionSize;
+        int partitions;
+        int bins;
+        RealFft fft;
+
+        /// @brief Each partition's spectrum, bins values apiece.
+        float *filterRe, *filterIm;
+
+        /// @brief The spectra of the most recent inputs, as a ring of partitions entries.
+        float *inputRe, *inputIm;
+        int newestInput = 0;
+
+        /// @brief The previous and the current input block, the window each forward FFT covers.
+        float *window;
+
+        /// @brief The sum of the products for the next output block.
+        float *sumRe, *sumIm;
+
+        /// @brief Time-domain scratch for the inverse FFT.
+        float *scratch;
+
+        /// @brief The output added over the current block.
+        float *output;
+
+        /// @brief Sets a partition's spectrum from taps, zero padding past the end of the response.
+        void setFilter(int partition, const float *taps, int count);
+
+        /// @brief Transforms the window into the newest input spectrum.
+        void pushInput(const float *windowData);
+
+        /// @brief Adds the products of partitions [first, last) to the sum. Partition 0 pairs with the newest input.
+        void accumulate(int first, int last);
+
+        /// @brief Inverse transforms the sum and keeps the valid half in out.
+        void finish(float *out);
+    };
+
+    /// @brief The arena space a convolver's buffers take for a response of length frames.
+    static size_t arenaBytes(int length);
+
+    /// @brief Holds the levels and every buffer below, so the convolver's working set is one block.
+    RealtimeArena arena;
+
+    /// @brief Builds a level in the arena, or returns null if it has no partitions.
+    Level *makeLevel(int partitionSize, int partitions);
+
+    /// @brief The short partitions, covering taps [HEAD_TAPS, TAIL_START), or null if the response is shorter.
+    Level *head;
+
+    /// @brief The long partitions, covering taps from TAIL_START on, or null if the response is shorter.
+    Level *tail;
+
+    /// @brief The position in the current small block.
+    int headPosition = 0;
+
+    /// @brief The small block within the current long block.
+    int tailBlock = 0;
+
+    /// @brief The long block waiting to be transformed, frozen while tailStep() works through it.
+    float *tailWindow;
+
+    /// @brief The long partitions' output for the next long block, built by the last tail step.
+    float *nextTailOutput;
+};
+
+#endif //GRAPHICS_CONVOLVER_H
@@ -0,0 +1,42 @@
+#ifndef GRAPHICS_DENORMALS_H
+#define GRAPHICS_DENORMALS_H
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Flushes denormal floats to zero on the current thread for as long as it exists.
+ * @details Decaying envelopes, filters and delay lines spend a long time at levels so small they become
+ * denormal, and denormal math runs many times slower on x86. Setting flush-to-zero and denormals-are-zero
+ * in MXCSR turns those values into zeros instead, which nothing can hear. The previous mode is restored
+ * on destruction, so a host thread lent to the audio callback is given back as it was found.
+ *
+ * Does nothing on other architectures.
+ */
+class ScopedFlushToZero {
+public:
+    ScopedFlushToZero() {
+#if defined(__x86_64__) || defined(_M_X64)
+        saved = _mm_getcsr();
+        _mm_setcsr(saved | FTZ | DAZ);
+#endif
+    }
+
+    ~ScopedFlushToZero() {
+#if defined(__x86_64__) || defined(_M_X64)
+        _mm_setcsr(saved);
+#endif
+    }
+
+    ScopedFlushToZero(const ScopedFlushToZero &) = delete;
+    ScopedFlushToZero &operator=(const ScopedFlushToZero &) = delete;
+
+private:
+    static constexpr unsigned int FTZ = 0x8000;
+    static constexpr unsigned int DAZ = 0x0040;
+
+    unsigned int saved = 0;
+};
+
+#endif //GRAPHICS_DENORMALS_H
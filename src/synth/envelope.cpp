@@ -0,0 +1,123 @@
+#include "envelope.h"
+
+#include <math.h>
+
+EnvelopeCoefficients EnvelopeCoefficients::fromSettings(const EnvelopeSettings &settings, double sampleRate) {
+    EnvelopeCoefficients coefficients;
+
+    double attackSamples = settings.attack * sampleRate;
+    coefficients.attackStep = attackSamples > 1.0 ? (float)(1.0 / attackSamples) : 1.0f;
+
+    // Decay covers 60 dB of the distance to the sustain level in the decay time, release covers 80 dB to silence
+    double decaySamples = settings.decay * sampleRate;
+    coefficients.decayMultiplier = decaySamples > 1.0 ? (float)exp(log(1e-3) / decaySamples) : 0.0f;
+
+    coefficients.sustain = settings.sustain;
+
+    double releaseSamples = settings.release * sampleRate;
+    coefficients.releaseMultiplier = releaseSamples > 1.0 ? (float)exp(log(1e-4) / releaseSamples) : 0.0f;
+
+    double fadeSamples = EnvelopeCoefficients::FADE_SECONDS * sampleRate;
+    coefficients.fadeMultiplier = fadeSamples > 1.0 ? (float)exp(log(1e-4) / fadeSamples) : 0.0f;
+
+    return coefficients;
+}
+
+void Envelope::noteOn() {
+    stage = Attack;
+}
+
+void Envelope::noteOff() {
+    if (stage != Idle && stage != Fade) {
+        stage = Release;
+    }
+}
+
+void Envelope::fadeOut() {
+    if (stage != Idle) {
+        stage = Fade;
+    }
+}
+
+void Envelope::reset() {
+    stage = Idle;
+    level = 0.0f;
+}
+
+bool Envelope::isActive() const {
+    return stage != Idle;
+}
+
+Envelope::Stage Envelope::getStage() const {
+    return stage;
+}
+
+float Envelope::getLevel() const {
+    return level;
+}
+
+void Envelope::render(const EnvelopeCoefficients &coefficients, float gain, float *out, unsigned long frames) {
+    unsigned long i = 0;
+    while (i < frames) {
+        switch (stage) {
+            case Idle: {
+                for (; i < frames; i++) {
+                    out[i] = 0.0f;
+                }
+                break;
+            }
+            case Attack: {
+                for (; i < frames && level < 1.0f; i++) {
+                    level += coefficients.attackStep;
+                    out[i] = gain * (level < 1.0f ? level : 1.0f);
+                }
+                if (level >= 1.0f) {
+                    level = 1.0f;
+                    stage = Decay;
+                }
+                break;
+            }
+            case Decay: {
+                // The sustain level may have been raised above the current level since the attack; curve up to it then
+                const float target = coefficients.sustain;
+                float distance = level - target;
+                for (; i < frames && fabsf(distance) > SILENCE; i++) {
+                    distance *= coefficients.decayMultiplier;
+                    out[i] = gain * (target + distance);
+                }
+                level = target + distance;
+                if (fabsf(distance) <= SILENCE) {
+                    level = target;
+                    stage = Sustain;
+                }
+                break;
+            }
+            case Sustain: {
+                // A sustain level changed while the key is down glides there over the fade time instead of stepping
+                const float target = coefficients.sustain;
+                float distance = level - target;
+                for (; i < frames && fabsf(distance) > SILENCE; i++) {
+                    distance *= coefficients.fadeMultiplier;
+                    out[i] = gain * (target + distance);
+                }
+                level = fabsf(distance) > SILENCE ? target + distance : target;
+                for (; i < frames; i++) {
+                    out[i] = gain * level;
+                }
+                break;
+            }
+            case Release:
+            case Fade: {
+                const float multiplier = stage == Release ? coefficients.releaseMultiplier : coefficients.fadeMultiplier;
+                for (; i < frames && level > SILENCE; i++) {
+                    level *= multiplier;
+                    out[i] = gain * level;
+                }
+                if (level <= SILENCE) {
+                    reset();
+                }
+                break;
+            }
+        }
+    }
+}
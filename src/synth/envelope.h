@@ -0,0 +1,75 @@
+#ifndef GRAPHICS_ENVELOPE_H
+#define GRAPHICS_ENVELOPE_H
+
+/**
+ * @brief ADSR times and sustain level.
+ *
+ * @param attack Seconds to rise from silence to full level
+ * @param decay Seconds to fall from full level to (roughly) the sustain level
+ * @param sustain Level held while the key is down, from 0 to 1
+ * @param release Seconds to fade to silence after the key is released
+ */
+struct EnvelopeSettings {
+    float attack;
+    float decay;
+    float sustain;
+    float release;
+};
+
+/**
+ * @brief Per-sample steps of an ADSR envelope at one sample rate.
+ * @details Computed once from EnvelopeSettings so the envelope itself never calls exp() or pow().
+ * Attack is a linear ramp. Decay and release are one-pole exponential curves: each sample moves
+ * the level a fixed fraction of the way to its target.
+ */
+struct EnvelopeCoefficients {
+    /// @brief How long a voice takes to fade out when it is stolen for another note.
+    static constexpr double FADE_SECONDS = 0.005;
+
+    float attackStep;
+    float decayMultiplier;
+    float sustain;
+    float releaseMultiplier;
+    float fadeMultiplier;
+
+    /// @brief Converts times in seconds to per-sample steps.
+    static EnvelopeCoefficients fromSettings(const EnvelopeSettings &settings, double sampleRate);
+};
+
+/// @brief The state of one voice's ADSR envelope.
+class Envelope {
+public:
+    enum Stage { Idle, Attack, Decay, Sustain, Release, Fade };
+
+    /// @brief Starts the attack from the current level.
+    void noteOn();
+
+    /// @brief Starts the release from the current level.
+    void noteOff();
+
+    /// @brief Fades out from the current level over EnvelopeCoefficients::FADE_SECONDS, whatever the release time.
+    void fadeOut();
+
+    /// @brief Silences the envelope immediately.
+    void reset();
+
+    /// @brief True until the release has faded out.
+    bool isActive() const;
+
+    Stage getStage() const;
+
+    float getLevel() const;
+
+    /// @brief Writes the envelope level, scaled by gain, for each of the next frames samples and advances the state.
+    /// @details Works one stage at a time, so the inner loops are straight-line multiply-adds.
+    void render(const EnvelopeCoefficients &coefficients, float gain, float *out, unsigned long frames);
+
+private:
+    /// @brief The level at which a fading envelope counts as silent (-80 dB).
+    static constexpr float SILENCE = 1e-4f;
+
+    Stage stage = Idle;
+    float level = 0.0f;
+};
+
+#endif //GRAPHICS_ENVELOPE_H
@@ -0,0 +1,259 @@
+#include "midiFile.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+namespace {
+
+/// @brief A channel or tempo event at an absolute tick, before the tempo map is applied.
+struct TickEvent {
+    unsigned long tick;
+    int order;              // position in the file, so events on the same tick keep their order
+    bool tempo;             // true for a tempo change, false for a note event
+    unsigned long tempoUs;  // microseconds per quarter note (tempo events only)
+    MidiEvent note;
+};
+
+/// @brief Bounds-checked big-endian reader over a byte buffer.
+class Reader {
+public:
+    Reader(const std::vector<unsigned char> &data, size_t begin, size_t end) : data(data), pos(begin), end(end) {}
+
+    bool atEnd() const { return pos >= end; }
+    size_t position() const { return pos; }
+
+    bool byte(unsigned int &value) {
+        if (pos >= end) return false;
+        value = data[pos++];
+        return true;
+    }
+
+    bool peek(unsigned int &value) const {
+        if (pos >= end) return false;
+        value = data[pos];
+        return true;
+    }
+
+    bool bigEndian(int bytes, unsigned long &value) {
+        value = 0;
+        for (int i = 0; i < bytes; i++) {
+            unsigned int b;
+            if (!byte(b)) return false;
+            value = (value << 8) | b;
+        }
+        return true;
+    }
+
+    /// @brief A variable-length quantity: 7 bits per byte, high bit set on every byte but the last.
+    bool variableLength(unsigned long &value) {
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            unsigned int b;
+            if (!byte(b)) return false;
+            value = (value << 7) | (b & 0x7F);
+            if ((b & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool skip(unsigned long bytes) {
+        if (bytes > end - pos) return false;
+        pos += bytes;
+        return true;
+    }
+
+private:
+    const std::vector<unsigned char> &data;
+    size_t pos;
+    size_t end;
+};
+
+bool parseTrack(Reader &track, std::vector<TickEvent> &events, int &order, std::string &error) {
+    unsigned long tick = 0;
+    unsigned int status = 0;
+
+    while (!track.atEnd()) {
+        unsigned long delta;
+        if (!track.variableLength(delta)) {
+            error = "truncated delta time";
+            return false;
+        }
+        tick += delta;
+
+        unsigned int first;
+        if (!track.peek(first)) {
+            error = "truncated event";
+            return false;
+        }
+        if (first & 0x80) {
+            track.byte(first);
+            // Meta and SysEx events cancel running status
+            status = (first < 0xF0) ? first : 0;
+        } else if (status == 0) {
+            error = "data byte without running status";
+            return false;
+        }
+
+        if (first == 0xFF) {
+            unsigned int type;
+            unsigned long length;
+            if (!track.byte(type) || !track.variableLength(length)) {
+                error = "truncated meta event";
+                return false;
+            }
+            if (type == 0x51 && length == 3) {
+                TickEvent tempo{};
+                tempo.tick = tick;
+                tempo.order = order++;
+                tempo.tempo = true;
+                if (!track.bigEndian(3, tempo.tempoUs)) {
+                    error = "truncated tempo";
+                    return false;
+                }
+                events.push_back(tempo);
+            } else if (type == 0x2F) {
+                return true; // end of track
+            } else if (!track.skip(length)) {
+                error = "truncated meta event";
+                return false;
+            }
+            continue;
+        }
+
+        if (first == 0xF0 || first == 0xF7) {
+            unsigned long length;
+            if (!track.variableLength(length) || !track.skip(length)) {
+                error = "truncated SysEx event";
+                return false;
+            }
+            continue;
+        }
+
+        unsigned int data1 = 0, data2 = 0;
+        unsigned int kind = status & 0xF0;
+        bool twoBytes = (kind != 0xC0 && kind != 0xD0);
+        if (!track.byte(data1) || (twoBytes && !track.byte(data2))) {
+            error = "truncated channel event";
+            return false;
+        }
+
+        if (kind == 0x90 || kind == 0x80) {
+            TickEvent note{};
+            note.tick = tick;
+            note.order = order++;
+            // A note-on with velocity 0 is a note-off
+            note.note.type = (kind == 0x90 && data2 > 0) ? NoteEvent::NoteOn : NoteEvent::NoteOff;
+            note.note.note = (int)data1;
+            note.note.velocity = (int)data2;
+            note.note.channel = (int)(status & 0x0F);
+            events.push_back(note);
+        } else if (kind == 0xB0 && data1 == 64) {
+            // Controller 64 is the sustain pedal, down from 64 up
+            TickEvent pedal{};
+            pedal.tick = tick;
+            pedal.order = order++;
+            pedal.note.type = data2 >= 64 ? NoteEvent::SustainOn : NoteEvent::SustainOff;
+            pedal.note.note = -1;
+            pedal.note.channel = (int)(status & 0x0F);
+            events.push_back(pedal);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool MidiFile::load(const std::string &path, std::vector<MidiEvent> &events, std::string &error) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        error = "could not open " + path;
+        return false;
+    }
+
+    std::vector<unsigned char> data;
+    unsigned char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    return parse(data, events, error);
+}
+
+bool MidiFile::parse(const std::vector<unsigned char> &data, std::vector<MidiEvent> &events, std::string &error) {
+    Reader file(data, 0, data.size());
+
+    unsigned long magic, headerLength, format, trackCount, division;
+    if (!file.bigEndian(4, magic) || magic != 0x4D546864 /* MThd */ || !file.bigEndian(4, headerLength)
+        || headerLength < 6 || !file.bigEndian(2, format) || !file.bigEndian(2, trackCount)
+        || !file.bigEndian(2, division) || !file.skip(headerLength - 6)) {
+        error = "not a MIDI file";
+        return false;
+    }
+    if (format > 1) {
+        error = "format 2 MIDI files are not supported";
+        return false;
+    }
+
+    std::vector<TickEvent> tickEvents;
+    int order = 0;
+    for (unsigned long t = 0; t < trackCount && !file.atEnd(); t++) {
+        unsigned long chunk, length;
+        if (!file.bigEndian(4, chunk) || !file.bigEndian(4, length)) {
+            error = "truncated track header";
+            return false;
+        }
+        size_t begin = file.position();
+        if (!file.skip(length)) {
+            error = "truncated track";
+            return false;
+        }
+        if (chunk != 0x4D54726B /* MTrk */) {
+            t--; // unknown chunks are skipped and do not count as tracks
+            continue;
+        }
+        Reader track(data, begin, begin + length);
+        if (!parseTrack(track, tickEvents, order, error)) {
+            return false;
+        }
+    }
+
+    std::stable_sort(tickEvents.begin(), tickEvents.end(), [](const TickEvent &a, const TickEvent &b) {
+        return a.tick != b.tick ? a.tick < b.tick : a.order < b.order;
+    });
+
+    // Walk the merged events, converting ticks to seconds with whichever tempo is in effect
+    bool smpte = (division & 0x8000) != 0;
+    double secondsPerTick;
+    if (smpte) {
+        int framesPerSecond = -(int)(signed char)(division >> 8);
+        secondsPerTick = 1.0 / (framesPerSecond * (double)(division & 0xFF));
+    } else {
+        secondsPerTick = 0.5 / (double)division; // 120 BPM until the first tempo event
+    }
+    // An SMPTE division with no ticks per frame divides by zero
+    if (division == 0 || !isfinite(secondsPerTick) || secondsPerTick <= 0.0) {
+        error = "invalid time division";
+        return false;
+    }
+
+    events.clear();
+    double time = 0.0;
+    unsigned long lastTick = 0;
+    for (const TickEvent &event : tickEvents) {
+        time += (event.tick - lastTick) * secondsPerTick;
+        lastTick = event.tick;
+        if (event.tempo) {
+            if (!smpte) {
+                secondsPerTick = event.tempoUs / 1e6 / (double)division;
+            }
+        } else {
+            MidiEvent note = event.note;
+            note.time = time;
+            events.push_back(note);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef GRAPHICS_MIDIFILE_H
+#define GRAPHICS_MIDIFILE_H
+
+#include <string>
+#include <vector>
+
+#include "noteEvent.h"
+
+/**
+ * @brief A note event read from a MIDI file.
+ *
+ * @param time When the event happens, in seconds from the start of the file
+ * @param type NoteEvent::NoteOn or NoteEvent::NoteOff, or NoteEvent::SustainOn or NoteEvent::SustainOff for the sustain pedal
+ * @param note The MIDI note number
+ * @param velocity The key velocity, 0 to 127
+ * @param channel The MIDI channel, 0 to 15
+ */
+struct MidiEvent {
+    double time;
+    NoteEvent::Type type;
+    int note;
+    int velocity;
+    int channel;
+};
+
+/**
+ * @brief Reads Standard MIDI Files (format 0 and 1).
+ * @details Tracks are merged and the tempo map is applied, so the result is one list of note
+ * and sustain pedal events in seconds, sorted by time.
+ */
+class MidiFile {
+public:
+    /// @brief Reads every note event from a file.
+    /// @param path The .mid file to read
+    /// @param events Receives the note events, sorted by time
+    /// @param error Receives a description of the problem if the file could not be read
+    /// @return true if the file was read
+    static bool load(const std::string &path, std::vector<MidiEvent> &events, std::string &error);
+
+    /// @brief Parses a MIDI file already in memory.
+    /// @see load()
+    static bool parse(const std::vector<unsigned char> &data, std::vector<MidiEvent> &events, std::string &error);
+};
+
+#endif //GRAPHICS_MIDIFILE_H
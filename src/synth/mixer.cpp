@@ -0,0 +1,149 @@
+#include "mixer.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SYNTH_X86 1
+#include <immintrin.h>
+#endif
+
+PanGains constantPowerPan(float pan) {
+    pan = pan < -1.0f ? -1.0f : (pan > 1.0f ? 1.0f : pan);
+    // Quarter circle from hard left to hard right, scaled by √2 so the centre is at unity
+    double angle = (pan + 1.0) * M_PI / 4.0;
+    PanGains gains;
+    gains.left = (float)(M_SQRT2 * cos(angle));
+    gains.right = (float)(M_SQRT2 * sin(angle));
+    return gains;
+}
+
+void addPanned(const float *in, float *left, float *right, unsigned long frames, PanGains from, PanGains to) {
+    if (frames == 0) {
+        return;
+    }
+    const float stepLeft = (to.left - from.left) / frames;
+    const float stepRight = (to.right - from.right) / frames;
+    unsigned long i = 0;
+
+#ifdef SYNTH_X86
+    __m128 gainLeft = _mm_add_ps(_mm_set1_ps(from.left), _mm_mul_ps(_mm_set1_ps(stepLeft), _mm_setr_ps(0, 1, 2, 3)));
+    __m128 gainRight = _mm_add_ps(_mm_set1_ps(from.right), _mm_mul_ps(_mm_set1_ps(stepRight), _mm_setr_ps(0, 1, 2, 3)));
+    const __m128 stepLeft4 = _mm_set1_ps(4.0f * stepLeft);
+    const __m128 stepRight4 = _mm_set1_ps(4.0f * stepRight);
+    for (; i + 4 <= frames; i += 4) {
+        __m128 sample = _mm_loadu_ps(in + i);
+        _mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), _mm_mul_ps(sample, gainLeft)));
+        _mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), _mm_mul_ps(sample, gainRight)));
+        gainLeft = _mm_add_ps(gainLeft, stepLeft4);
+        gainRight = _mm_add_ps(gainRight, stepRight4);
+    }
+#endif
+
+    for (; i < frames; i++) {
+        left[i] += in[i] * (from.left + stepLeft * i);
+        right[i] += in[i] * (from.right + stepRight * i);
+    }
+}
+
+LookaheadLimiter::LookaheadLimiter(double sampleRate) {
+    lookahead = (unsigned long)(LOOKAHEAD_SECONDS * sampleRate + 0.5);
+    lookahead = lookahead < 1 ? 1 : (lookahead >= MAX_LOOKAHEAD ? MAX_LOOKAHEAD - 1 : lookahead);
+    // One-pole recovery reaching 1 - 1/e of the way back over the release time
+    release = (float)(1.0 - exp(-1.0 / (RELEASE_SECONDS * sampleRate)));
+    reset();
+}
+
+void LookaheadLimiter::reset() {
+    for (unsigned long i = 0; i < MAX_LOOKAHEAD; i++) {
+        held[i] = 1.0f;
+        required[i] = 1.0f;
+    }
+    heldSum = (double)lookahead;
+    heldIndex = 0;
+    windowHead = 0;
+    windowTail = 0;
+    released = 1.0f;
+    gain = 1.0f;
+    frameCount = 0;
+    memset(delayLeft, 0, sizeof(delayLeft));
+    memset(delayRight, 0, sizeof(delayRight));
+}
+
+unsigned long LookaheadLimiter::getLatency() const {
+    return lookahead;
+}
+
+float LookaheadLimiter::getGain() const {
+    return gain;
+}
+
+void LookaheadLimiter::process(const float *left, const float *right, float *out, unsigned long frames) {
+    constexpr unsigned long MASK = MAX_LOOKAHEAD - 1;
+    if (frames == 0) {
+        return;
+    }
+    memcpy(delayLeft + lookahead, left, frames * sizeof(float));
+    memcpy(delayRight + lookahead, right, frames * sizeof(float));
+
+    // The gain each incoming frame needs on its own
+    unsigned long i = 0;
+#ifdef SYNTH_X86
+    const __m128 ceiling = _mm_set1_ps(CEILING);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (; i + 4 <= frames; i += 4) {
+        __m128 peak = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(left + i), absMask),
+                                 _mm_and_ps(_mm_loadu_ps(right + i), absMask));
+        _mm_store_ps(blockGain + i, _mm_div_ps(ceiling, _mm_max_ps(peak, ceiling)));
+    }
+#endif
+    for (; i < frames; i++) {
+        float peak = fabsf(left[i]) > fabsf(right[i]) ? fabsf(left[i]) : fabsf(right[i]);
+        blockGain[i] = CEILING / (peak > CEILING ? peak : CEILING);
+    }
+
+    // The lowest gain any frame within the look-ahead needs, released slowly, then ramped over the look-ahead.
+    // Every frame averaged into a ramp covers the frame leaving the delay, so the ramp is never above what it needs.
+    for (i = 0; i < frames; i++) {
+        const uint64_t frame = frameCount++;
+        const float needed = blockGain[i];
+        while (windowTail != windowHead && required[window[(windowTail - 1) & MASK] & MASK] >= needed) {
+            windowTail--;
+        }
+        required[frame & MASK] = needed;
+        window[windowTail++ & MASK] = frame;
+        if (window[windowHead & MASK] + lookahead < frame) {
+            windowHead++;
+        }
+        const float lowest = required[window[windowHead & MASK] & MASK];
+
+        released = lowest < released ? lowest : released + release * (lowest - released);
+        heldSum += released - held[heldIndex];
+        held[heldIndex] = released;
+        if (++heldIndex == lookahead) {
+            heldIndex = 0;
+        }
+        float ramp = (float)(heldSum / lookahead);
+        blockGain[i] = ramp < 1.0f ? ramp : 1.0f;
+    }
+    gain = blockGain[frames - 1];
+
+    // Apply the gain to the delayed signal and interleave
+    i = 0;
+#ifdef SYNTH_X86
+    for (; i + 4 <= frames; i += 4) {
+        __m128 g = _mm_load_ps(blockGain + i);
+        __m128 l = _mm_mul_ps(_mm_loadu_ps(delayLeft + i), g);
+        __m128 r = _mm_mul_ps(_mm_loadu_ps(delayRight + i), g);
+        _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+#endif
+    for (; i < frames; i++) {
+        out[2 * i] = delayLeft[i] * blockGain[i];
+        out[2 * i + 1] = delayRight[i] * blockGain[i];
+    }
+
+    memmove(delayLeft, delayLeft + frames, lookahead * sizeof(float));
+    memmove(delayRight, delayRight + frames, lookahead * sizeof(float));
+}
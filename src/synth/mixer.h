@@ -0,0 +1,100 @@
+#ifndef GRAPHICS_MIXER_H
+#define GRAPHICS_MIXER_H
+
+#include <cstdint>
+
+/// @brief A voice's gains into the left and right channels.
+struct PanGains {
+    float left = 1.0f;
+    float right = 1.0f;
+};
+
+/// @brief Constant-power gains for a position in the stereo field.
+/// @details left² + right² is the same everywhere, so a voice is equally loud wherever it sits. The law is
+/// scaled to unity in the centre, so a centred voice is as loud in each channel as a mono one.
+/// @param pan -1 for hard left, 0 for the centre, 1 for hard right
+PanGains constantPowerPan(float pan);
+
+/// @brief Adds a mono signal to a planar stereo pair, ramping linearly from one pair of gains to another over the block.
+/// @details The ramp is worked out once for the block, so nothing is recomputed per sample.
+void addPanned(const float *in, float *left, float *right, unsigned long frames, PanGains from, PanGains to);
+
+/**
+ * @brief A stereo peak limiter that sees peaks coming and turns down before them.
+ * @details The signal is delayed by the look-ahead time. The gain each peak needs is spread back over the
+ * look-ahead as a linear ramp, so the gain is already down when the peak leaves the delay and nothing ever
+ * passes the ceiling, without the distortion of clipping or of a gain that jumps. Afterwards the gain
+ * recovers over the release time. Both channels get the same gain, so the stereo image does not shift.
+ *
+ * The peak detection and gain application are vectorized over the block. Only the gain envelope, which
+ * depends on its own last value, is worked out one frame at a time.
+ *
+ * Everything is preallocated; process() never allocates or blocks.
+ */
+class LookaheadLimiter {
+public:
+    /// @brief The most frames processed in one call.
+    static constexpr unsigned long MAX_FRAMES = 256;
+
+    /// @brief How far ahead the limiter looks, and so how much it delays the signal.
+    static constexpr double LOOKAHEAD_SECONDS = 0.0015;
+
+    /// @brief How long the gain takes to recover most of the way after a peak.
+    static constexpr double RELEASE_SECONDS = 0.08;
+
+    /// @brief The highest peak let through, a little under full scale to leave room for dither.
+    static constexpr float CEILING = 0.97f;
+
+    /// @param sampleRate The rate of the signal
+    explicit LookaheadLimiter(double sampleRate);
+
+    /// @brief Limits a block and writes it interleaved, lookahead frames late.
+    /// @param left The left channel, frames samples
+    /// @param right The right channel, frames samples
+    /// @param out The interleaved stereo output, 2 * frames samples
+    /// @param frames The number of frames, at most MAX_FRAMES
+    void process(const float *left, const float *right, float *out, unsigned long frames);
+
+    /// @brief Clears the delay and the gain.
+    void reset();
+
+    /// @brief The delay the look-ahead adds, in frames.
+    unsigned long getLatency() const;
+
+    /// @brief The gain applied to the last frame, 1 when the limiter is idle.
+    float getGain() const;
+
+private:
+    /// @brief Room for the longest look-ahead at any supported rate, a power of two.
+    static constexpr unsigned long MAX_LOOKAHEAD = 512;
+
+    unsigned long lookahead;
+    float release;
+
+    /// @brief The gain every recent frame needs, for the sliding minimum, indexed by frame count.
+    float required[MAX_LOOKAHEAD];
+
+    /// @brief Frame counts of the candidates for the window's minimum, oldest first, with rising required gains.
+    uint64_t window[MAX_LOOKAHEAD];
+    unsigned long windowHead = 0;
+    unsigned long windowTail = 0;
+
+    /// @brief The recent released gains, which the ramp averages.
+    float held[MAX_LOOKAHEAD];
+    double heldSum = 0.0;
+    unsigned long heldIndex = 0;
+    float released = 1.0f;
+    float gain = 1.0f;
+
+    /// @brief Frames seen so far. 64 bits even where long is 32, so the window's comparisons never see it wrap.
+    uint64_t frameCount = 0;
+
+    /// @brief The last lookahead frames of input followed by the block being processed.
+    float delayLeft[MAX_LOOKAHEAD + MAX_FRAMES];
+    float delayRight[MAX_LOOKAHEAD + MAX_FRAMES];
+
+    /// @brief Per-frame scratch for the block.
+    alignas(16) float blockGain[MAX_FRAMES];
+};
+
+#endif //GRAPHICS_MIXER_H
@@ -0,0 +1,21 @@
+#ifndef GRAPHICS_NOTEEVENT_H
+#define GRAPHICS_NOTEEVENT_H
+
+/// @brief A note event sent from the input thread to the audio callback.
+struct NoteEvent {
+    enum Type { NoteOn, NoteOff, AllNotesOff, SustainOn, SustainOff, SequenceStart, SequenceStop };
+
+    /// @brief What the event does.
+    Type type;
+
+    /// @brief The MIDI note the event applies to. Ignored by AllNotesOff, the sustain pedal and the sequence events.
+    int note;
+
+    /// @brief How hard the key was struck, 1 to 127. Picks a sample pack's velocity layer.
+    int velocity;
+
+    /// @brief When the event happened, in seconds on the stream's clock.
+    double time;
+};
+
+#endif //GRAPHICS_NOTEEVENT_H
@@ -0,0 +1,34 @@
+#ifndef GRAPHICS_OSCILLATOR_H
+#define GRAPHICS_OSCILLATOR_H
+
+#include <cstdint>
+
+#include "renderKernel.h"
+
+/**
+ * @brief The portable wavetable oscillator.
+ * @details Reads the voice's table at a 32-bit fixed-point phase with linear interpolation between the two
+ * neighbouring entries and adds the result to a mono output. The signature matches RenderVoiceFunction, so
+ * render() is the scalar render kernel and the tail loop of the SIMD ones.
+ */
+struct Oscillator {
+    /// @brief The table at a phase, a straight line between the two neighbouring entries.
+    static float read(const float *table, uint32_t phase) {
+        const uint32_t index = phase >> PHASE_FRACTION_BITS;
+        const float fraction = (float)(phase & ((1u << PHASE_FRACTION_BITS) - 1))
+                               * (1.0f / (float)(1u << PHASE_FRACTION_BITS));
+        return table[index] + fraction * (table[index + 1] - table[index]);
+    }
+
+    static void render(const float *table, uint32_t &phase, uint32_t increment,
+                       const float *gain, float *out, unsigned long frames) {
+        uint32_t p = phase;
+        for (unsigned long i = 0; i < frames; i++) {
+            out[i] += gain[i] * read(table, p);
+            p += increment; // wraps at the end of the cycle
+        }
+        phase = p;
+    }
+};
+
+#endif //GRAPHICS_OSCILLATOR_H
@@ -0,0 +1,104 @@
+#include "polyphaseResampler.h"
+
+#include <math.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SYNTH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// @brief The cutoff of band 0 in cycles per source frame, a little below Nyquist to leave room for the transition.
+constexpr double CUTOFF = 0.45;
+
+/// @brief The Kaiser window's shape: about 70 dB of stopband attenuation.
+constexpr double KAISER_BETA = 7.0;
+
+/// @brief The zeroth-order modified Bessel function, which the Kaiser window is made of.
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+} // namespace
+
+PolyphaseResampler::PolyphaseResampler() : filters((size_t)BANDS * (PHASES + 1) * TAPS) {
+    const double halfLength = TAPS / 2.0;
+    const double windowScale = 1.0 / besselI0(KAISER_BETA);
+
+    for (int band = 0; band < BANDS; band++) {
+        bandLimits[band] = bandLimit(band);
+        double cutoff = CUTOFF / pow(2.0, band / 2.0);
+        for (int phase = 0; phase <= PHASES; phase++) {
+            float *row = &filters[((size_t)band * (PHASES + 1) + phase) * TAPS];
+            double fraction = (double)phase / PHASES;
+            double sum = 0.0;
+            for (int tap = 0; tap < TAPS; tap++) {
+                // How far this tap's frame is from the read position
+                double t = tap - HISTORY - fraction;
+                double x = 2.0 * cutoff * t;
+                double sinc = fabs(x) < 1e-9 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+                double edge = t / halfLength;
+                double window = fabs(edge) < 1.0 ? besselI0(KAISER_BETA * sqrt(1.0 - edge * edge)) * windowScale : 0.0;
+                row[tap] = (float)(sinc * window);
+                sum += row[tap];
+            }
+            // Unity gain at DC for every phase, so a held level does not ripple as the fraction moves
+            for (int tap = 0; tap < TAPS; tap++) {
+                row[tap] = (float)(row[tap] / sum);
+            }
+        }
+    }
+}
+
+const PolyphaseResampler &PolyphaseResampler::shared() {
+    static const PolyphaseResampler resampler;
+    return resampler;
+}
+
+const float *PolyphaseResampler::filterFor(uint64_t increment) const {
+    int band = 0;
+    while (band < BANDS - 1 && increment > bandLimits[band]) {
+        band++;
+    }
+    return &filters[(size_t)band * (PHASES + 1) * TAPS];
+}
+
+uint64_t PolyphaseResampler::bandLimit(int band) {
+    return (uint64_t)(pow(2.0, band / 2.0) * 4294967296.0 + 0.5);
+}
+
+float PolyphaseResampler::interpolate(const float *filter, const float *frames, uint32_t fraction) {
+    constexpr int BLEND_BITS = 32 - PHASE_BITS;
+    const float *below = filter + (fraction >> BLEND_BITS) * TAPS;
+    const float *above = below + TAPS;
+    const float blend = (float)(fraction & ((1u << BLEND_BITS) - 1)) * (1.0f / (float)(1u << BLEND_BITS));
+
+#ifdef SYNTH_X86
+    __m128 weight = _mm_set1_ps(blend);
+    __m128 sum = _mm_setzero_ps();
+    for (int tap = 0; tap < TAPS; tap += 4) {
+        __m128 low = _mm_loadu_ps(below + tap);
+        __m128 coefficient = _mm_add_ps(low, _mm_mul_ps(weight, _mm_sub_ps(_mm_loadu_ps(above + tap), low)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(coefficient, _mm_loadu_ps(frames + tap)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#else
+    float sum = 0.0f;
+    for (int tap = 0; tap < TAPS; tap++) {
+        sum += (below[tap] + blend * (above[tap] - below[tap])) * frames[tap];
+    }
+    return sum;
+#endif
+}
@@ -0,0 +1,63 @@
+#ifndef GRAPHICS_POLYPHASERESAMPLER_H
+#define GRAPHICS_POLYPHASERESAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Band-limited interpolation for playing a recording at any rate and pitch.
+ * @details Reading a sample between two frames is a convolution with a windowed sinc centred on the read
+ * position. The sinc is tabulated for PHASES fractional positions, and the two rows around the real position
+ * are blended, so any fraction is handled with one small table. Each row is TAPS long and is applied with SSE.
+ *
+ * Reading faster than the recording's rate moves its top octave above the output's Nyquist, where it would
+ * alias. The table therefore holds a few bands, each with its cutoff lowered for a range of read speeds, and
+ * filterFor() picks the one a voice needs.
+ *
+ * The tables are built once and are read-only afterwards, so any number of threads can share them.
+ */
+class PolyphaseResampler {
+public:
+    /// @brief The number of frames each output sample is computed from.
+    static constexpr int TAPS = 32;
+
+    /// @brief How many of those frames come before the read position. The rest are at and after it.
+    static constexpr int HISTORY = TAPS / 2 - 1;
+
+    /// @brief The number of fractional positions tabulated, as a power of two.
+    static constexpr int PHASE_BITS = 7;
+    static constexpr int PHASES = 1 << PHASE_BITS;
+
+    /// @brief The number of cutoff bands. Band b covers read speeds up to 2^(b/2) times the recording's rate.
+    /// @details The last reaches 16x: a 192 kHz recording on a 44.1 kHz device played nearly two octaves above its
+    /// root. Faster reads use it too and are no longer fully band-limited.
+    static constexpr int BANDS = 9;
+
+    /// @brief Builds every band's table with a Kaiser-windowed sinc. Takes a few milliseconds.
+    PolyphaseResampler();
+
+    /// @brief A process-wide resampler, built the first time it is asked for.
+    static const PolyphaseResampler &shared();
+
+    /// @brief The filter for a read speed.
+    /// @param increment Source frames per output frame, in 32.32 fixed point
+    const float *filterFor(uint64_t increment) const;
+
+    /// @brief The fastest read speed a band is built for, 2^(band/2), in 32.32 fixed point.
+    static uint64_t bandLimit(int band);
+
+    /// @brief One output sample.
+    /// @param filter The filter returned by filterFor()
+    /// @param frames TAPS consecutive source frames, starting HISTORY frames before the read position
+    /// @param fraction How far past its frame the read position is, in 1/2^32 of a frame
+    static float interpolate(const float *filter, const float *frames, uint32_t fraction);
+
+private:
+    /// @brief Every band's (PHASES + 1) x TAPS coefficients back to back. The extra row is the next frame's phase 0.
+    std::vector<float> filters;
+
+    /// @brief bandLimit() of every band, so picking a filter needs no pow().
+    uint64_t bandLimits[BANDS];
+};
+
+#endif //GRAPHICS_POLYPHASERESAMPLER_H
@@ -0,0 +1,119 @@
+#include "realFft.h"
+
+#include <math.h>
+
+RealFft::RealFft(int size, RealtimeArena &arena)
+        : size(size), half(size / 2), bitReverse(arena.allocate<int>(size / 2)),
+          butterflyRe(arena.allocate<float>(size / 2)), butterflyIm(arena.allocate<float>(size / 2)),
+          splitRe(arena.allocate<float>(size / 2 + 1)), splitIm(arena.allocate<float>(size / 2 + 1)),
+          scratchRe(arena.allocate<float>(size / 2)), scratchIm(arena.allocate<float>(size / 2)) {
+    int bits = 0;
+    while ((1 << bits) < half) {
+        bits++;
+    }
+    for (int i = 0; i < half; i++) {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; bit++) {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        bitReverse[i] = reversed;
+        butterflyRe[i] = (float)cos(-2.0 * M_PI * i / half);
+        butterflyIm[i] = (float)sin(-2.0 * M_PI * i / half);
+    }
+    for (int k = 0; k <= half; k++) {
+        splitRe[k] = (float)cos(-2.0 * M_PI * k / size);
+        splitIm[k] = (float)sin(-2.0 * M_PI * k / size);
+    }
+}
+
+size_t RealFft::arenaBytes(int size) {
+    return RealtimeArena::bytesFor<int>(size / 2) + 4 * RealtimeArena::bytesFor<float>(size / 2)
+           + 2 * RealtimeArena::bytesFor<float>(size / 2 + 1);
+}
+
+int RealFft::getSize() const {
+    return size;
+}
+
+int RealFft::getBins() const {
+    return half + 1;
+}
+
+void RealFft::complexFft(float *re, float *im, bool inverse) const {
+    for (int i = 0; i < half; i++) {
+        int j = bitReverse[i];
+        if (j > i) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    const float sign = inverse ? -1.0f : 1.0f;
+    for (int length = 2; length <= half; length <<= 1) {
+        int span = length / 2;
+        int stride = half / length;
+        for (int start = 0; start < half; start += length) {
+            for (int k = 0; k < span; k++) {
+                float wr = butterflyRe[k * stride];
+                float wi = sign * butterflyIm[k * stride];
+                int a = start + k;
+                int b = a + span;
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+void RealFft::forward(const float *in, float *re, float *im) {
+    // Even samples as the real part, odd samples as the imaginary part
+    float *zr = scratchRe;
+    float *zi = scratchIm;
+    for (int n = 0; n < half; n++) {
+        zr[n] = in[2 * n];
+        zi[n] = in[2 * n + 1];
+    }
+    complexFft(zr, zi, false);
+
+    // X[k] = E[k] + W^k O[k], with E and O the spectra of the even and odd samples
+    for (int k = 0; k <= half; k++) {
+        int a = k % half;
+        int b = (half - k) % half;
+        float evenRe = 0.5f * (zr[a] + zr[b]);
+        float evenIm = 0.5f * (zi[a] - zi[b]);
+        float oddRe = 0.5f * (zi[a] + zi[b]);
+        float oddIm = -0.5f * (zr[a] - zr[b]);
+        re[k] = evenRe + splitRe[k] * oddRe - splitIm[k] * oddIm;
+        im[k] = evenIm + splitRe[k] * oddIm + splitIm[k] * oddRe;
+    }
+}
+
+void RealFft::inverse(const float *re, const float *im, float *out) {
+    float *zr = scratchRe;
+    float *zi = scratchIm;
+
+    // Rebuild the even and odd spectra and pack them as Z = E + iO
+    for (int k = 0; k < half; k++) {
+        int m = half - k;
+        float evenRe = 0.5f * (re[k] + re[m]);
+        float evenIm = 0.5f * (im[k] - im[m]);
+        float diffRe = 0.5f * (re[k] - re[m]);
+        float diffIm = 0.5f * (im[k] + im[m]);
+        // O = (X[k] - conj(X[half - k])) / 2 * W^-k
+        float oddRe = diffRe * splitRe[k] + diffIm * splitIm[k];
+        float oddIm = diffIm * splitRe[k] - diffRe * splitIm[k];
+        zr[k] = evenRe - oddIm;
+        zi[k] = evenIm + oddRe;
+    }
+    complexFft(zr, zi, true);
+
+    const float scale = 1.0f / half;
+    for (int n = 0; n < half; n++) {
+        out[2 * n] = zr[n] * scale;
+        out[2 * n + 1] = zi[n] * scale;
+    }
+}
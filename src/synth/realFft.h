@@ -0,0 +1,52 @@
+#ifndef GRAPHICS_REALFFT_H
+#define GRAPHICS_REALFFT_H
+
+#include "realtimeArena.h"
+
+/**
+ * @brief A forward and inverse FFT of real signals of one power-of-two size.
+ * @details Runs a complex FFT of half the size on the even and odd samples and untangles the result,
+ * so real signals cost half as much as a plain complex FFT. Spectra are stored split into real and
+ * imaginary arrays of size / 2 + 1 bins, which keeps multiply-accumulate loops over them vectorizable.
+ *
+ * Twiddles and scratch space are taken from the owner's arena by the constructor, so forward() and inverse() never
+ * allocate and the tables sit with the buffers they transform. An instance is not safe to use from two threads at once.
+ */
+class RealFft {
+public:
+    /// @param size The transform size, a power of two of at least 4
+    /// @param arena Where the tables and scratch space come from, with arenaBytes(size) free. Must outlive the FFT.
+    RealFft(int size, RealtimeArena &arena);
+
+    RealFft(const RealFft &) = delete;
+    RealFft &operator=(const RealFft &) = delete;
+
+    /// @brief The arena space a transform of size takes.
+    static size_t arenaBytes(int size);
+
+    int getSize() const;
+
+    /// @brief The number of bins in a spectrum, size / 2 + 1.
+    int getBins() const;
+
+    /// @brief Transforms size real samples into getBins() complex bins.
+    void forward(const float *in, float *re, float *im);
+
+    /// @brief Transforms getBins() complex bins back into size real samples, scaled so that inverse(forward(x)) == x.
+    void inverse(const float *re, const float *im, float *out);
+
+private:
+    /// @brief In-place complex FFT of size / 2 points. inverse selects the sign of the exponent; no scaling.
+    void complexFft(float *re, float *im, bool inverse) const;
+
+    int size;
+    int half;
+    int *bitReverse;
+    /// @brief e^(-2 pi i k / half) for the complex FFT's butterflies.
+    float *butterflyRe, *butterflyIm;
+    /// @brief e^(-2 pi i k / size) for splitting the half-size result into the real spectrum.
+    float *splitRe, *splitIm;
+    float *scratchRe, *scratchIm;
+};
+
+#endif //GRAPHICS_REALFFT_H
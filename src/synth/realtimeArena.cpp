@@ -0,0 +1,25 @@
+#include "realtimeArena.h"
+
+#include <new>
+#include <string.h>
+
+RealtimeArena::RealtimeArena(size_t capacity) : capacity(capacity) {
+    if (capacity > 0) {
+        block = static_cast<unsigned char *>(::operator new(capacity, std::align_val_t(ALIGNMENT)));
+        memset(block, 0, capacity);
+    }
+}
+
+RealtimeArena::~RealtimeArena() {
+    if (block != nullptr) {
+        ::operator delete(block, std::align_val_t(ALIGNMENT));
+    }
+}
+
+size_t RealtimeArena::getCapacity() const {
+    return capacity;
+}
+
+size_t RealtimeArena::getUsed() const {
+    return used;
+}
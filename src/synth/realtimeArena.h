@@ -0,0 +1,63 @@
+#ifndef GRAPHICS_REALTIMEARENA_H
+#define GRAPHICS_REALTIMEARENA_H
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief One preallocated block that an object's audio-path buffers are carved out of.
+ * @details The owner sizes the arena when it is built, off the audio thread, and takes every buffer it will ever
+ * need from it up front. Buffers are never freed one at a time; the whole block goes with the arena. The buffers
+ * sit next to each other instead of wherever the heap put them, and the block is written through once when it is
+ * made, so the audio thread never takes a page fault on it.
+ */
+class RealtimeArena {
+public:
+    /// @brief Every buffer starts on a cache line.
+    static constexpr size_t ALIGNMENT = 64;
+
+    /// @brief The space count values take in an arena, padding included, for sizing one.
+    template <typename T>
+    static constexpr size_t bytesFor(size_t count) {
+        return (count * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    /// @brief An empty arena with no block.
+    RealtimeArena() = default;
+
+    /// @brief Allocates and zeroes the block.
+    /// @param capacity The size of the block in bytes
+    explicit RealtimeArena(size_t capacity);
+
+    ~RealtimeArena();
+
+    RealtimeArena(const RealtimeArena &) = delete;
+    RealtimeArena &operator=(const RealtimeArena &) = delete;
+
+    /// @brief Takes a zeroed buffer of count values from the block.
+    /// @return the buffer, or null if the block is too full for it
+    template <typename T>
+    T *allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena buffers are never destroyed");
+        size_t bytes = bytesFor<T>(count);
+        if (bytes > capacity - used) {
+            return nullptr;
+        }
+        T *buffer = reinterpret_cast<T *>(block + used);
+        used += bytes;
+        return buffer;
+    }
+
+    /// @brief The size of the block in bytes.
+    size_t getCapacity() const;
+
+    /// @brief The bytes handed out so far.
+    size_t getUsed() const;
+
+private:
+    unsigned char *block = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+#endif //GRAPHICS_REALTIMEARENA_H
@@ -0,0 +1,211 @@
+#include "realtimeGuard.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string.h>
+
+#if defined(SYNTH_REALTIME_CHECKS) && !defined(_MSC_VER)
+#define SYNTH_REALTIME_TRIPWIRE 1
+#include <unistd.h>
+#endif
+
+namespace {
+
+thread_local bool realtimeThread = false;
+
+std::atomic<uint64_t> realtimeAllocations{0};
+
+}
+
+ScopedRealtimeThread::ScopedRealtimeThread() : previous(realtimeThread) {
+    realtimeThread = true;
+}
+
+ScopedRealtimeThread::~ScopedRealtimeThread() {
+    realtimeThread = previous;
+}
+
+bool isRealtimeThread() {
+    return realtimeThread;
+}
+
+uint64_t getRealtimeAllocationCount() {
+    return realtimeAllocations.load(std::memory_order_relaxed);
+}
+
+#ifdef SYNTH_REALTIME_TRIPWIRE
+
+#ifdef __GLIBC__
+// glibc's own entry points, which the replacements below forward to
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *pointer);
+}
+#endif
+
+namespace {
+
+/// @brief The number of heap calls reported in full before the rest are only counted.
+constexpr uint64_t MAX_REPORTS = 16;
+
+void writeError(const char *text) {
+    ssize_t written = write(STDERR_FILENO, text, strlen(text));
+    (void)written;
+}
+
+/// @brief Reports a heap call made on a real-time thread. Must not allocate itself.
+void reportRealtimeCall(const char *function) {
+    uint64_t count = realtimeAllocations.fetch_add(1, std::memory_order_relaxed);
+    const char *mode = getenv("SYNTH_REALTIME_CHECKS");
+    bool logOnly = mode != nullptr && strcmp(mode, "log") == 0;
+    if (count < MAX_REPORTS || !logOnly) {
+        writeError("ERROR::REALTIME: ");
+        writeError(function);
+        writeError(" called on a real-time thread\n");
+    }
+    if (!logOnly) {
+        abort();
+    }
+}
+
+inline void checkRealtime(const char *function) {
+    if (realtimeThread) {
+        reportRealtimeCall(function);
+    }
+}
+
+void *rawMalloc(size_t size) {
+#ifdef __GLIBC__
+    return __libc_malloc(size);
+#else
+    return malloc(size);
+#endif
+}
+
+void *rawAlignedAlloc(size_t alignment, size_t size) {
+#ifdef __GLIBC__
+    return __libc_memalign(alignment, size);
+#else
+    void *pointer = nullptr;
+    return posix_memalign(&pointer, alignment < sizeof(void *) ? sizeof(void *) : alignment, size) == 0 ? pointer : nullptr;
+#endif
+}
+
+void rawFree(void *pointer) {
+#ifdef __GLIBC__
+    __libc_free(pointer);
+#else
+    free(pointer);
+#endif
+}
+
+void *checkedNew(size_t size, const char *function) {
+    checkRealtime(function);
+    void *pointer = rawMalloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void *checkedAlignedNew(size_t size, std::align_val_t alignment, const char *function) {
+    checkRealtime(function);
+    void *pointer = rawAlignedAlloc((size_t)alignment, size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void checkedDelete(void *pointer) {
+    if (pointer != nullptr) {
+        checkRealtime("operator delete");
+        rawFree(pointer);
+    }
+}
+
+}
+
+void *operator new(size_t size) {
+    return checkedNew(size, "operator new");
+}
+
+void *operator new[](size_t size) {
+    return checkedNew(size, "operator new[]");
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    checkRealtime("operator new");
+    return rawMalloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    checkRealtime("operator new[]");
+    return rawMalloc(size == 0 ? 1 : size);
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    return checkedAlignedNew(size, alignment, "operator new");
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return checkedAlignedNew(size, alignment, "operator new[]");
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    checkRealtime("operator new");
+    return rawAlignedAlloc((size_t)alignment, size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    checkRealtime("operator new[]");
+    return rawAlignedAlloc((size_t)alignment, size == 0 ? 1 : size);
+}
+
+void operator delete(void *pointer) noexcept { checkedDelete(pointer); }
+void operator delete[](void *pointer) noexcept { checkedDelete(pointer); }
+void operator delete(void *pointer, size_t) noexcept { checkedDelete(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { checkedDelete(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { checkedDelete(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { checkedDelete(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept { checkedDelete(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { checkedDelete(pointer); }
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept { checkedDelete(pointer); }
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept { checkedDelete(pointer); }
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept { checkedDelete(pointer); }
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept { checkedDelete(pointer); }
+
+#ifdef __GLIBC__
+// C code and the C library allocate through these, so they are caught too
+extern "C" {
+
+void *malloc(size_t size) noexcept {
+    checkRealtime("malloc");
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept {
+    checkRealtime("calloc");
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) noexcept {
+    checkRealtime("realloc");
+    return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer) noexcept {
+    if (pointer != nullptr) {
+        checkRealtime("free");
+    }
+    __libc_free(pointer);
+}
+
+}
+#endif
+
+#endif
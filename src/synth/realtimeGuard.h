@@ -0,0 +1,34 @@
+#ifndef GRAPHICS_REALTIMEGUARD_H
+#define GRAPHICS_REALTIMEGUARD_H
+
+#include <cstdint>
+
+/**
+ * @brief Marks the current thread as real-time for as long as it exists.
+ * @details A thread with a deadline every buffer must never touch the heap, which can take a lock or a page
+ * fault at any time. Builds with SYNTH_REALTIME_CHECKS (Debug builds, or any build with -DREALTIME_CHECKS=ON)
+ * replace operator new and operator delete, and malloc and free on glibc, with versions that report any call
+ * made on a marked thread and abort, so a debugger stops on the call. Run with SYNTH_REALTIME_CHECKS=log in the
+ * environment to only report and count them.
+ *
+ * In other builds this only sets a thread-local flag. Marks nest, and the previous state is restored on destruction.
+ */
+class ScopedRealtimeThread {
+public:
+    ScopedRealtimeThread();
+    ~ScopedRealtimeThread();
+
+    ScopedRealtimeThread(const ScopedRealtimeThread &) = delete;
+    ScopedRealtimeThread &operator=(const ScopedRealtimeThread &) = delete;
+
+private:
+    bool previous;
+};
+
+/// @brief Whether the calling thread is marked real-time.
+bool isRealtimeThread();
+
+/// @brief How many heap calls marked threads have made. Always 0 without SYNTH_REALTIME_CHECKS.
+uint64_t getRealtimeAllocationCount();
+
+#endif //GRAPHICS_REALTIMEGUARD_H
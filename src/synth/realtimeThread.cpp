@@ -0,0 +1,139 @@
+#include "realtimeThread.h"
+
+#include <cerrno>
+#include <sstream>
+#include <string.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+ThreadPlacement placeHandle(pthread_t thread, int priority, int core) {
+    ThreadPlacement placement;
+    placement.priority = priority;
+    placement.core = core;
+    if (core >= 0) {
+        if (core >= CPU_SETSIZE) {
+            placement.coreError = EINVAL;
+        } else {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(core, &cpus);
+            placement.coreError = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+        }
+    }
+    if (priority > 0) {
+        sched_param param{};
+        param.sched_priority = priority;
+        placement.priorityError = pthread_setschedparam(thread, SCHED_FIFO, &param);
+    }
+    return placement;
+}
+#else
+ThreadPlacement unsupportedPlacement(int priority, int core) {
+    ThreadPlacement placement;
+    placement.priority = priority;
+    placement.core = core;
+    placement.priorityError = priority > 0 ? ENOTSUP : 0;
+    placement.coreError = core >= 0 ? ENOTSUP : 0;
+    return placement;
+}
+#endif
+
+} // namespace
+
+bool RealtimeOptions::requested() const {
+    return priority > 0 || !cores.empty() || lockMemory;
+}
+
+int RealtimeOptions::coreFor(int thread) const {
+    return thread >= 0 && thread < (int)cores.size() ? cores[thread] : -1;
+}
+
+bool RealtimeOptions::parseCores(const std::string &list, std::vector<int> &cores) {
+    std::vector<int> parsed;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty() || item.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        parsed.push_back(std::stoi(item));
+    }
+    if (parsed.empty()) {
+        return false;
+    }
+    cores = parsed;
+    return true;
+}
+
+ThreadPlacement placeCurrentThread(int priority, int core) {
+#ifdef __linux__
+    return placeHandle(pthread_self(), priority, core);
+#else
+    return unsupportedPlacement(priority, core);
+#endif
+}
+
+ThreadPlacement placeThread(std::thread &thread, int priority, int core) {
+#ifdef __linux__
+    return placeHandle(thread.native_handle(), priority, core);
+#else
+    (void) thread;
+    return unsupportedPlacement(priority, core);
+#endif
+}
+
+std::string describePlacement(const std::string &name, const ThreadPlacement &placement) {
+    std::ostringstream line;
+    line << name << ": ";
+    if (placement.priority <= 0) {
+        line << "normal priority";
+    } else if (placement.priorityError == 0) {
+        line << "SCHED_FIFO priority " << placement.priority;
+    } else {
+        line << "normal priority, SCHED_FIFO " << placement.priority << " refused (" << strerror(placement.priorityError)
+             << "; raise rtprio in /etc/security/limits.conf or grant CAP_SYS_NICE)";
+    }
+    if (placement.core >= 0) {
+        if (placement.coreError == 0) {
+            line << ", pinned to core " << placement.core;
+        } else {
+            line << ", not pinned to core " << placement.core << " (" << strerror(placement.coreError) << ")";
+        }
+    }
+    return line.str();
+}
+
+bool lockProcessMemory(std::string &error, const void *skip, size_t skipBytes) {
+#ifdef __linux__
+    // Without MCL_ONFAULT a mapped sample pack would be read in whole before it could be unlocked below
+#ifdef MCL_ONFAULT
+    int flags = MCL_CURRENT | MCL_ONFAULT;
+#else
+    int flags = MCL_CURRENT;
+#endif
+    if (mlockall(flags) != 0) {
+        int code = errno;
+        error = strerror(code);
+        if (code == ENOMEM || code == EPERM) {
+            error += "; raise memlock in /etc/security/limits.conf (ulimit -l) or grant CAP_IPC_LOCK";
+        }
+        return false;
+    }
+    if (skip != nullptr && skipBytes > 0) {
+        munlock(skip, skipBytes);
+    }
+    return true;
+#else
+    (void)skip;
+    (void)skipBytes;
+    error = "memory locking is only supported on Linux";
+    return false;
+#endif
+}
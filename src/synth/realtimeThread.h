@@ -0,0 +1,70 @@
+#ifndef GRAPHICS_REALTIMETHREAD_H
+#define GRAPHICS_REALTIMETHREAD_H
+
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief How the audio thread and the synth's render threads should be scheduled.
+struct RealtimeOptions {
+    /// @brief SCHED_FIFO priority for the audio thread, 1 to 99, or 0 to leave its scheduling to the host.
+    /// @details Render threads run one step below it, so they never preempt the thread waiting on them. At priority 1
+    /// there is no step below, so they keep normal scheduling.
+    int priority = 0;
+
+    /// @brief Cores to pin to: the audio thread's first, then each render thread's in turn.
+    /// @details Threads past the end of the list are not pinned. With an empty list the audio thread is not
+    /// pinned and the render threads are spread over every core but the first.
+    std::vector<int> cores;
+
+    /// @brief Whether to lock the process's memory into RAM once the synth has warmed up.
+    bool lockMemory = false;
+
+    /// @brief Whether any of the options asks for something.
+    bool requested() const;
+
+    /// @brief The core listed for a thread, 0 for the audio thread and 1 on for the render threads, or -1 if none is.
+    int coreFor(int thread) const;
+
+    /// @brief Parses a comma-separated list of core numbers, such as "2,3,4".
+    /// @return false if the list has anything but non-negative numbers in it
+    static bool parseCores(const std::string &list, std::vector<int> &cores);
+};
+
+/// @brief What a thread asked the scheduler for and what it was refused.
+struct ThreadPlacement {
+    /// @brief The SCHED_FIFO priority asked for, or 0 if none was.
+    int priority = 0;
+
+    /// @brief The core asked for, or -1 if none was.
+    int core = -1;
+
+    /// @brief The errno the scheduler refused the priority with, or 0 if it was granted or not asked for.
+    int priorityError = 0;
+
+    /// @brief The errno pinning failed with, or 0 if it worked or was not asked for.
+    int coreError = 0;
+};
+
+/// @brief Raises the calling thread to SCHED_FIFO and pins it to a core. Both are best effort.
+/// @details Makes no allocations, so a render thread the host created can call it on itself.
+/// @param priority 1 to 99, or 0 to leave the scheduling alone
+/// @param core The core to pin to, or -1 to leave the affinity alone
+ThreadPlacement placeCurrentThread(int priority, int core);
+
+/// @brief Raises another thread to SCHED_FIFO and pins it to a core. Both are best effort.
+ThreadPlacement placeThread(std::thread &thread, int priority, int core);
+
+/// @brief One line saying what a thread got and, for anything refused, what to change to get it.
+std::string describePlacement(const std::string &name, const ThreadPlacement &placement);
+
+/// @brief Locks the pages the process has in RAM, so the audio path never waits on a page fault.
+/// @details Pages mapped later are not locked; nothing on the audio path maps or allocates once it runs. Where the
+/// OS supports it, pages mapped but never touched are only locked once they are, so call it after a warm-up.
+/// @param error Set to the reason and a way round it on failure
+/// @param skip A mapping to leave pageable, such as a sample pack the streamer reads and releases, or null
+/// @param skipBytes The size of that mapping
+/// @return false if the OS refused
+bool lockProcessMemory(std::string &error, const void *skip = nullptr, size_t skipBytes = 0);
+
+#endif //GRAPHICS_REALTIMETHREAD_H
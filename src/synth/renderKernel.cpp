@@ -0,0 +1,150 @@
+#include "renderKernel.h"
+#include "oscillator.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SYNTH_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions marked for it, so the rest of the
+// binary still runs on CPUs without AVX2. MSVC emits any intrinsic without a flag.
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace {
+
+const float FRACTION_SCALE = 1.0f / (float)(1u << PHASE_FRACTION_BITS);
+const uint32_t FRACTION_MASK = (1u << PHASE_FRACTION_BITS) - 1;
+
+/// @brief The portable kernel, also used for the tails the SIMD kernels leave over.
+constexpr RenderVoiceFunction renderVoiceScalar = &Oscillator::render;
+
+#ifdef SYNTH_X86
+
+void renderVoiceSse2(const float *table, uint32_t &phase, uint32_t increment,
+                     const float *gain, float *out, unsigned long frames) {
+    const __m128i step = _mm_set1_epi32((int)(increment * 4));
+    const __m128i fractionMask = _mm_set1_epi32((int)FRACTION_MASK);
+    const __m128 fractionScale = _mm_set1_ps(FRACTION_SCALE);
+
+    // Four consecutive samples per lane group
+    __m128i p = _mm_setr_epi32((int)phase, (int)(phase + increment),
+                               (int)(phase + 2 * increment), (int)(phase + 3 * increment));
+
+    unsigned long i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        alignas(16) int32_t index[4];
+        _mm_store_si128((__m128i*)index, _mm_srli_epi32(p, PHASE_FRACTION_BITS));
+
+        // SSE2 has no gather, so load the table entries one lane at a time
+        __m128 a = _mm_setr_ps(table[index[0]], table[index[1]], table[index[2]], table[index[3]]);
+        __m128 b = _mm_setr_ps(table[index[0] + 1], table[index[1] + 1], table[index[2] + 1], table[index[3] + 1]);
+        __m128 fraction = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p, fractionMask)), fractionScale);
+        __m128 sample = _mm_add_ps(a, _mm_mul_ps(fraction, _mm_sub_ps(b, a)));
+
+        __m128 g = _mm_loadu_ps(gain + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(g, sample)));
+        p = _mm_add_epi32(p, step);
+    }
+
+    uint32_t tailPhase = phase + (uint32_t)i * increment;
+    renderVoiceScalar(table, tailPhase, increment, gain + i, out + i, frames - i);
+    phase = tailPhase;
+}
+
+TARGET_AVX2
+void renderVoiceAvx2(const float *table, uint32_t &phase, uint32_t increment,
+                     const float *gain, float *out, unsigned long frames) {
+    const __m256i step = _mm256_set1_epi32((int)(increment * 8));
+    const __m256i fractionMask = _mm256_set1_epi32((int)FRACTION_MASK);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 fractionScale = _mm256_set1_ps(FRACTION_SCALE);
+
+    __m256i p = _mm256_setr_epi32((int)phase, (int)(phase + increment),
+                                  (int)(phase + 2 * increment), (int)(phase + 3 * increment),
+                                  (int)(phase + 4 * increment), (int)(phase + 5 * increment),
+                                  (int)(phase + 6 * increment), (int)(phase + 7 * increment));
+
+    unsigned long i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256i index = _mm256_srli_epi32(p, PHASE_FRACTION_BITS);
+        __m256 a = _mm256_i32gather_ps(table, index, 4);
+        __m256 b = _mm256_i32gather_ps(table, _mm256_add_epi32(index, one), 4);
+        __m256 fraction = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(p, fractionMask)), fractionScale);
+        __m256 sample = _mm256_add_ps(a, _mm256_mul_ps(fraction, _mm256_sub_ps(b, a)));
+
+        __m256 g = _mm256_loadu_ps(gain + i);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(g, sample)));
+        p = _mm256_add_epi32(p, step);
+    }
+
+    uint32_t tailPhase = phase + (uint32_t)i * increment;
+    renderVoiceScalar(table, tailPhase, increment, gain + i, out + i, frames - i);
+    phase = tailPhase;
+}
+
+bool cpuHasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    // The OS must also save the upper halves of the YMM registers
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    return avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    return false;
+#endif
+}
+
+#endif // SYNTH_X86
+
+const RenderKernel SCALAR_KERNEL = {"scalar", renderVoiceScalar};
+#ifdef SYNTH_X86
+const RenderKernel SSE2_KERNEL = {"sse2", renderVoiceSse2};
+const RenderKernel AVX2_KERNEL = {"avx2", renderVoiceAvx2};
+#endif
+
+const RenderKernel &detectRenderKernel() {
+#ifdef SYNTH_X86
+    if (cpuHasAvx2()) {
+        return AVX2_KERNEL;
+    }
+    // Every x86-64 CPU has SSE2
+    return SSE2_KERNEL;
+#else
+    return SCALAR_KERNEL;
+#endif
+}
+
+} // namespace
+
+const RenderKernel &selectRenderKernel() {
+    static const RenderKernel &kernel = detectRenderKernel();
+    return kernel;
+}
+
+const RenderKernel &scalarRenderKernel() {
+    return SCALAR_KERNEL;
+}
+
+bool cpuSupportsAvx2() {
+#ifdef SYNTH_X86
+    static const bool supported = cpuHasAvx2();
+    return supported;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,46 @@
+#ifndef GRAPHICS_RENDERKERNEL_H
+#define GRAPHICS_RENDERKERNEL_H
+
+#include <cstdint>
+
+/// @brief Wavetables hold 2^WAVETABLE_BITS entries, plus one guard entry equal to the first.
+constexpr int WAVETABLE_BITS = 11;
+
+/// @brief The number of entries in one cycle of a wavetable.
+constexpr int WAVETABLE_SIZE = 1 << WAVETABLE_BITS;
+
+/// @brief The number of low bits of a 32-bit phase below the table index, used as the interpolation fraction.
+constexpr int PHASE_FRACTION_BITS = 32 - WAVETABLE_BITS;
+
+/**
+ * @brief Renders one wavetable voice into a mono block.
+ * @details Reads the table with linear interpolation, scales each sample by its gain and adds the result to out.
+ * The phase is advanced by frames * increment.
+ *
+ * @param table A wavetable of WAVETABLE_SIZE + 1 entries
+ * @param phase The voice's 32-bit fixed-point phase
+ * @param increment How far the phase advances per sample
+ * @param gain The gain applied to each sample before accumulating (e.g. the voice's envelope)
+ * @param out The mono block to accumulate into
+ * @param frames The number of samples to render
+ */
+typedef void (*RenderVoiceFunction)(const float *table, uint32_t &phase, uint32_t increment,
+                                    const float *gain, float *out, unsigned long frames);
+
+/// @brief A voice rendering kernel and the instruction set it was built for.
+struct RenderKernel {
+    const char *name;
+    RenderVoiceFunction renderVoice;
+};
+
+/// @brief Picks the fastest kernel the CPU supports (AVX2, then SSE2, then scalar).
+/// @details Checks CPUID once and caches the result.
+const RenderKernel &selectRenderKernel();
+
+/// @brief The portable kernel, available on every CPU.
+const RenderKernel &scalarRenderKernel();
+
+/// @brief Whether the CPU and the OS support AVX2, for other code that picks its own kernels.
+bool cpuSupportsAvx2();
+
+#endif //GRAPHICS_RENDERKERNEL_H
@@ -0,0 +1,282 @@
+#include "sampleCodec.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SYNTH_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+/// @brief 24-bit full scale.
+constexpr float SCALE = 8388608.0f;
+
+/// @brief The Rice parameter that marks a partition stored raw.
+constexpr int RAW_PARTITION = 31;
+
+/// @brief Bits per raw sample difference: a difference of two 24-bit samples needs 25.
+constexpr int RAW_BITS = 25;
+
+/// @brief Bits used to store a partition's Rice parameter.
+constexpr int PARAMETER_BITS = 5;
+
+uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+int countLeadingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(value);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (int)index;
+#else
+    int count = 0;
+    while (!(value & (1ull << 63))) {
+        value <<= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/// @brief Writes bits most significant first.
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<unsigned char> &out) : out(out) {}
+
+    void write(uint32_t value, int bits) {
+        for (int i = bits - 1; i >= 0; i--) {
+            current = (unsigned char)((current << 1) | ((value >> i) & 1));
+            if (++used == 8) {
+                out.push_back(current);
+                current = 0;
+                used = 0;
+            }
+        }
+    }
+
+    void writeUnary(uint32_t zeros) {
+        for (uint32_t i = 0; i < zeros; i++) {
+            write(0, 1);
+        }
+        write(1, 1);
+    }
+
+    void flush() {
+        if (used > 0) {
+            out.push_back((unsigned char)(current << (8 - used)));
+            current = 0;
+            used = 0;
+        }
+    }
+
+private:
+    std::vector<unsigned char> &out;
+    unsigned char current = 0;
+    int used = 0;
+};
+
+/// @brief Reads bits most significant first through a 64-bit window. Reads past the end see zeros.
+class BitReader {
+public:
+    BitReader(const unsigned char *data, size_t size) : next(data), end(data + size), sizeBits((uint64_t)size * 8) {
+        refill();
+    }
+
+    /// @brief Reads up to 32 bits.
+    uint32_t read(int bits) {
+        if (bits == 0) {
+            return 0;
+        }
+        refill();
+        uint32_t value = (uint32_t)(window >> (64 - bits));
+        window <<= bits;
+        available -= bits;
+        consumed += bits;
+        return value;
+    }
+
+    /// @brief Reads a run of zeros ended by a one. Returns a value above MAX_QUOTIENT if the run is too long.
+    uint32_t readUnary() {
+        refill();
+        if (window == 0) {
+            return SampleCodec::MAX_QUOTIENT + 1;
+        }
+        int zeros = countLeadingZeros(window);
+        window <<= zeros + 1;
+        available -= zeros + 1;
+        consumed += zeros + 1;
+        return (uint32_t)zeros;
+    }
+
+    /// @brief True if more bits were read than the data holds.
+    bool overran() const {
+        return consumed > sizeBits;
+    }
+
+private:
+    void refill() {
+        while (available <= 56) {
+            uint64_t byte = next < end ? *next++ : 0;
+            window |= byte << (56 - available);
+            available += 8;
+        }
+    }
+
+    const unsigned char *next;
+    const unsigned char *end;
+    uint64_t sizeBits;
+    uint64_t consumed = 0;
+    uint64_t window = 0;
+    int available = 0;
+};
+
+/// @brief Undoes the differences and converts back to float: out[i] = (first + d[1] + ... + d[i]) / SCALE.
+void integrate(int32_t first, const int32_t *differences, float *out, int frames) {
+    int32_t running = first;
+    out[0] = first / SCALE;
+    int i = 1;
+#ifdef SYNTH_X86
+    // Four-lane prefix sum: two shifted adds, then the running total from the previous four
+    const __m128 scale = _mm_set1_ps(1.0f / SCALE);
+    __m128i carry = _mm_set1_epi32(running);
+    for (; i + 4 <= frames; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(differences + i));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, carry);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+        carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    running = _mm_cvtsi128_si32(carry);
+#endif
+    for (; i < frames; i++) {
+        // Wrap like the SIMD path rather than overflow on corrupt data
+        running = (int32_t)((uint32_t)running + (uint32_t)differences[i]);
+        out[i] = running / SCALE;
+    }
+}
+
+} // namespace
+
+void SampleCodec::encodeBlock(const float *samples, int frames, std::vector<unsigned char> &out) {
+    int32_t values[BLOCK_FRAMES];
+    for (int i = 0; i < frames; i++) {
+        float sample = samples[i];
+        if (sample > 1.0f) sample = 1.0f;
+        if (sample < -1.0f) sample = -1.0f;
+        // Round to 24 bits, keeping +1.0 inside the range
+        float scaled = sample * SCALE;
+        int32_t value = (int32_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+        values[i] = value > 8388607 ? 8388607 : value;
+    }
+
+    BitWriter writer(out);
+    if (frames == 0) {
+        return;
+    }
+    writer.write((uint32_t)values[0] & 0xFFFFFF, 24);
+
+    for (int start = 1; start < frames; start += PARTITION_FRAMES) {
+        int end = start + PARTITION_FRAMES < frames ? start + PARTITION_FRAMES : frames;
+        uint32_t residuals[PARTITION_FRAMES];
+        for (int i = start; i < end; i++) {
+            residuals[i - start] = zigzag(values[i] - values[i - 1]);
+        }
+        int count = end - start;
+
+        // Pick the cheapest Rice parameter whose unary runs all fit, or store the partition raw
+        int best = RAW_PARTITION;
+        uint64_t bestBits = (uint64_t)RAW_BITS * count;
+        for (int k = 0; k < RAW_BITS; k++) {
+            uint64_t bits = 0;
+            bool fits = true;
+            for (int i = 0; i < count; i++) {
+                uint32_t quotient = residuals[i] >> k;
+                if (quotient > MAX_QUOTIENT) {
+                    fits = false;
+                    break;
+                }
+                bits += quotient + 1 + k;
+            }
+            if (fits && bits < bestBits) {
+                best = k;
+                bestBits = bits;
+            }
+        }
+
+        writer.write((uint32_t)best, PARAMETER_BITS);
+        for (int i = 0; i < count; i++) {
+            if (best == RAW_PARTITION) {
+                writer.write(residuals[i], RAW_BITS);
+            } else {
+                writer.writeUnary(residuals[i] >> best);
+                writer.write(residuals[i] & ((1u << best) - 1), best);
+            }
+        }
+    }
+    writer.flush();
+}
+
+bool SampleCodec::decodeBlock(const unsigned char *block, size_t size, float *out, int frames) {
+    if (frames <= 0) {
+        return true;
+    }
+    if (frames > BLOCK_FRAMES) {
+        memset(out, 0, frames * sizeof(float));
+        return false;
+    }
+
+    BitReader reader(block, size);
+    // Sign-extend the 24-bit first sample
+    int32_t first = (int32_t)(reader.read(24) << 8) >> 8;
+
+    int32_t differences[BLOCK_FRAMES];
+    for (int start = 1; start < frames; start += PARTITION_FRAMES) {
+        int end = start + PARTITION_FRAMES < frames ? start + PARTITION_FRAMES : frames;
+        int k = (int)reader.read(PARAMETER_BITS);
+        if (k == RAW_PARTITION) {
+            for (int i = start; i < end; i++) {
+                differences[i] = unzigzag(reader.read(RAW_BITS));
+            }
+        } else if (k < RAW_BITS) {
+            for (int i = start; i < end; i++) {
+                uint32_t quotient = reader.readUnary();
+                if (quotient > MAX_QUOTIENT) {
+                    memset(out, 0, frames * sizeof(float));
+                    return false;
+                }
+                differences[i] = unzigzag((quotient << k) | reader.read(k));
+            }
+        } else {
+            memset(out, 0, frames * sizeof(float));
+            return false;
+        }
+    }
+    if (reader.overran()) {
+        memset(out, 0, frames * sizeof(float));
+        return false;
+    }
+
+    integrate(first, differences, out, frames);
+    return true;
+}
+
+const char *SampleCodec::getDecoderName() {
+#ifdef SYNTH_X86
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,47 @@
+#ifndef GRAPHICS_SAMPLECODEC_H
+#define GRAPHICS_SAMPLECODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Lossless compression for 24-bit sample data in independently decodable blocks.
+ * @details Samples are quantized to 24 bits, so 16 and 24-bit recordings come back exactly. Each block
+ * of BLOCK_FRAMES samples stores its first sample raw and the rest as differences from the previous sample,
+ * Rice coded with a parameter chosen per PARTITION_FRAMES-sample partition. A partition that Rice coding
+ * would not shrink is stored raw instead.
+ *
+ * Any block decodes without the ones before it. The unary part of a Rice code is capped at
+ * MAX_QUOTIENT, so the worst case per sample is fixed and decoding a block takes bounded time.
+ * The difference-undoing prefix sum and the conversion back to float use SSE2 where available.
+ */
+class SampleCodec {
+public:
+    /// @brief Samples per block. Streaming and seeking work in whole blocks.
+    static constexpr int BLOCK_FRAMES = 2048;
+
+    /// @brief Samples per Rice parameter.
+    static constexpr int PARTITION_FRAMES = 256;
+
+    /// @brief The longest unary run the encoder writes; partitions that would need more are stored raw.
+    static constexpr int MAX_QUOTIENT = 32;
+
+    /// @brief Compresses up to BLOCK_FRAMES samples and appends the block to out.
+    /// @param samples Samples in [-1, 1], clipped if outside
+    /// @param frames The number of samples, at most BLOCK_FRAMES
+    static void encodeBlock(const float *samples, int frames, std::vector<unsigned char> &out);
+
+    /// @brief Decodes one block.
+    /// @param block The encoded block
+    /// @param size The block's size in bytes
+    /// @param out Receives the samples
+    /// @param frames The number of samples the block holds
+    /// @return false if the block is corrupt, in which case out is silent
+    static bool decodeBlock(const unsigned char *block, size_t size, float *out, int frames);
+
+    /// @brief The SIMD path decodeBlock() uses on this build ("sse2" or "scalar").
+    static const char *getDecoderName();
+};
+
+#endif //GRAPHICS_SAMPLECODEC_H
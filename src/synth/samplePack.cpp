@@ -0,0 +1,438 @@
+#include "samplePack.h"
+#include "sampleCodec.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[4] = {'S', 'P', 'A', 'K'};
+/// @brief Version 2 added compressed zones. Version 1 packs are all Float32 and still open.
+constexpr uint32_t VERSION = 2;
+
+/// @brief Zone data starts on a boundary this large, so pages can be released one zone at a time.
+constexpr uint64_t DATA_ALIGNMENT = 4096;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sampleRate;
+    uint32_t zoneCount;
+};
+static_assert(sizeof(FileHeader) == 16, "pack header layout");
+
+struct FileZone {
+    uint8_t rootNote;
+    uint8_t lowNote;
+    uint8_t highNote;
+    uint8_t lowVelocity;
+    uint8_t highVelocity;
+    uint8_t padding[3];
+    uint64_t dataOffset; // bytes from the start of the file
+    uint64_t frames;
+    uint32_t encoding;   // SampleEncoding, always 0 in version 1
+    uint32_t reserved;
+};
+static_assert(sizeof(FileZone) == 32, "pack zone layout");
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint64_t blockCount(uint64_t frames) {
+    return (frames + SampleCodec::BLOCK_FRAMES - 1) / SampleCodec::BLOCK_FRAMES;
+}
+
+/// @brief The frames kept resident for a zone: HEAD_SECONDS, rounded up to whole blocks for compressed zones.
+uint64_t headFramesFor(const FileZone &zone, uint64_t headLimit) {
+    if (zone.encoding == (uint32_t)SampleEncoding::Rice24) {
+        headLimit = alignUp(headLimit, SampleCodec::BLOCK_FRAMES);
+    }
+    return zone.frames < headLimit ? zone.frames : headLimit;
+}
+
+/// @brief Checks that a zone's data lies inside the file, so reading it can never fault.
+bool validZone(const FileZone &zone, uint32_t version, size_t fileSize, const unsigned char *mapping,
+               std::string &error) {
+    uint32_t encoding = version == 1 ? 0 : zone.encoding;
+    if (encoding == (uint32_t)SampleEncoding::Float32) {
+        if (zone.dataOffset % sizeof(float) != 0 || zone.dataOffset > fileSize ||
+            zone.frames > (fileSize - zone.dataOffset) / sizeof(float)) {
+            error = "zone data runs past the end of the file";
+            return false;
+        }
+        return true;
+    }
+    if (encoding != (uint32_t)SampleEncoding::Rice24) {
+        error = "unknown sample encoding " + std::to_string(encoding);
+        return false;
+    }
+
+    uint64_t blocks = blockCount(zone.frames);
+    uint64_t tableBytes = (blocks + 1) * sizeof(uint64_t);
+    if (zone.dataOffset % sizeof(uint64_t) != 0 || zone.dataOffset > fileSize || tableBytes > fileSize - zone.dataOffset) {
+        error = "zone block table runs past the end of the file";
+        return false;
+    }
+    const uint64_t *offsets = (const uint64_t *)(mapping + zone.dataOffset);
+    uint64_t previous = tableBytes;
+    for (uint64_t block = 0; block <= blocks; block++) {
+        if (offsets[block] < previous || offsets[block] > fileSize - zone.dataOffset) {
+            error = "zone block table is corrupt";
+            return false;
+        }
+        previous = offsets[block];
+    }
+    return true;
+}
+
+long pageSize() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (long)info.dwAllocationGranularity;
+#else
+    return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+/// @brief Moves to a byte of a file with a 64-bit offset; long is only 32 bits on Windows, and packs pass 2 GB.
+bool seekTo(FILE *file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+} // namespace
+
+SamplePack::~SamplePack() {
+    close();
+}
+
+bool SamplePack::open(const std::string &path, std::string &error) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "could not open " + path;
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *view = map != nullptr ? MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr) {
+        if (map != nullptr) CloseHandle(map);
+        CloseHandle(file);
+        error = "could not map " + path;
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = map;
+    mapping = (const unsigned char *)view;
+    mappingSize = (size_t)size.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "could not open " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        error = "could not read " + path;
+        return false;
+    }
+    void *view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive on its own
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        error = "could not map " + path;
+        return false;
+    }
+    // Samples are read front to back, so let the kernel read ahead aggressively
+    madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+    mapping = (const unsigned char *)view;
+    mappingSize = (size_t)info.st_size;
+#endif
+
+    FileHeader header;
+    if (mappingSize < sizeof(header)) {
+        error = "file is too short to be a sample pack";
+        close();
+        return false;
+    }
+    memcpy(&header, mapping, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not a sample pack";
+        close();
+        return false;
+    }
+    if (header.version < 1 || header.version > VERSION) {
+        error = "unsupported sample pack version " + std::to_string(header.version);
+        close();
+        return false;
+    }
+    if (sizeof(header) + (uint64_t)header.zoneCount * sizeof(FileZone) > mappingSize) {
+        error = "zone table runs past the end of the file";
+        close();
+        return false;
+    }
+
+    sampleRate = header.sampleRate;
+    uint64_t headLimit = (uint64_t)(HEAD_SECONDS * sampleRate);
+
+    std::vector<FileZone> fileZones(header.zoneCount);
+    memcpy(fileZones.data(), mapping + sizeof(header), header.zoneCount * sizeof(FileZone));
+
+    // Check every zone and size the heads first, so pointers into the heads stay valid
+    uint64_t totalHeadFrames = 0;
+    for (const FileZone &fileZone : fileZones) {
+        if (!validZone(fileZone, header.version, mappingSize, mapping, error)) {
+            close();
+            return false;
+        }
+        totalHeadFrames += headFramesFor(fileZone, headLimit);
+    }
+    heads.resize(totalHeadFrames);
+
+    uint64_t headOffset = 0;
+    for (const FileZone &fileZone : fileZones) {
+        SampleZone zone;
+        zone.rootNote = fileZone.rootNote;
+        zone.lowNote = fileZone.lowNote;
+        zone.highNote = fileZone.highNote;
+        zone.lowVelocity = fileZone.lowVelocity;
+        zone.highVelocity = fileZone.highVelocity;
+        zone.frames = fileZone.frames;
+        zone.encoding = (SampleEncoding)fileZone.encoding;
+        zone.data = mapping + fileZone.dataOffset;
+        zone.headFrames = headFramesFor(fileZone, headLimit);
+        readFrames(zone, 0, zone.headFrames, &heads[headOffset]);
+        zone.head = &heads[headOffset];
+        headOffset += zone.headFrames;
+
+        // The copy is all the audio thread will see of these pages
+        releaseFrames(zone, 0, zone.headFrames);
+        zones.push_back(zone);
+    }
+
+    buildLookup();
+    return true;
+}
+
+void SamplePack::close() {
+    if (mapping != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+        CloseHandle((HANDLE)mappingHandle);
+        CloseHandle((HANDLE)fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap((void *)mapping, mappingSize);
+#endif
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    sampleRate = 0;
+    zones.clear();
+    heads.clear();
+    zoneLookup.clear();
+}
+
+bool SamplePack::isOpen() const {
+    return mapping != nullptr;
+}
+
+void SamplePack::buildLookup() {
+    zoneLookup.assign(128 * NUM_VELOCITIES, -1);
+    for (size_t i = 0; i < zones.size(); i++) {
+        const SampleZone &zone = zones[i];
+        for (int note = zone.lowNote; note <= zone.highNote && note < 128; note++) {
+            for (int velocity = zone.lowVelocity; velocity <= zone.highVelocity && velocity < NUM_VELOCITIES; velocity++) {
+                // The first zone listed for a key wins
+                int16_t &slot = zoneLookup[note * NUM_VELOCITIES + velocity];
+                if (slot == -1) {
+                    slot = (int16_t)i;
+                }
+            }
+        }
+    }
+}
+
+const SampleZone *SamplePack::findZone(int note, int velocity) const {
+    if (zoneLookup.empty() || note < 0 || note >= 128) {
+        return nullptr;
+    }
+    velocity = velocity < 0 ? 0 : (velocity >= NUM_VELOCITIES ? NUM_VELOCITIES - 1 : velocity);
+    int16_t index = zoneLookup[note * NUM_VELOCITIES + velocity];
+    return index < 0 ? nullptr : &zones[index];
+}
+
+double SamplePack::getSampleRate() const {
+    return sampleRate;
+}
+
+size_t SamplePack::getZoneCount() const {
+    return zones.size();
+}
+
+const SampleZone &SamplePack::getZone(size_t index) const {
+    return zones[index];
+}
+
+size_t SamplePack::getResidentBytes() const {
+    return heads.size() * sizeof(float) + zones.size() * sizeof(SampleZone) + zoneLookup.size() * sizeof(int16_t);
+}
+
+const void *SamplePack::getMapping() const {
+    return mapping;
+}
+
+size_t SamplePack::getMappingSize() const {
+    return mappingSize;
+}
+
+void SamplePack::readFrames(const SampleZone &zone, uint64_t first, uint64_t count, float *out) const {
+    if (zone.encoding == SampleEncoding::Float32) {
+        memcpy(out, (const float *)zone.data + first, count * sizeof(float));
+        return;
+    }
+
+    const uint64_t *offsets = (const uint64_t *)zone.data;
+    const uint64_t blockFrames = SampleCodec::BLOCK_FRAMES;
+    while (count > 0) {
+        uint64_t block = first / blockFrames;
+        uint64_t skip = first % blockFrames;
+        uint64_t framesInBlock = zone.frames - block * blockFrames < blockFrames ? zone.frames - block * blockFrames
+                                                                                 : blockFrames;
+        uint64_t take = framesInBlock - skip < count ? framesInBlock - skip : count;
+        const unsigned char *bytes = zone.data + offsets[block];
+        size_t size = (size_t)(offsets[block + 1] - offsets[block]);
+
+        if (skip == 0 && take == framesInBlock) {
+            SampleCodec::decodeBlock(bytes, size, out, (int)framesInBlock);
+        } else {
+            float block[SampleCodec::BLOCK_FRAMES];
+            SampleCodec::decodeBlock(bytes, size, block, (int)framesInBlock);
+            memcpy(out, block + skip, take * sizeof(float));
+        }
+        out += take;
+        first += take;
+        count -= take;
+    }
+}
+
+void SamplePack::byteRange(const SampleZone &zone, uint64_t first, uint64_t last, const unsigned char *&begin,
+                           const unsigned char *&end) const {
+    if (zone.encoding == SampleEncoding::Float32) {
+        begin = zone.data + first * sizeof(float);
+        end = zone.data + last * sizeof(float);
+        return;
+    }
+    // Only blocks that are entirely inside the range
+    const uint64_t *offsets = (const uint64_t *)zone.data;
+    uint64_t firstBlock = blockCount(first);
+    uint64_t lastBlock = last >= zone.frames ? blockCount(zone.frames) : last / SampleCodec::BLOCK_FRAMES;
+    begin = zone.data + offsets[firstBlock < lastBlock ? firstBlock : lastBlock];
+    end = zone.data + offsets[lastBlock];
+}
+
+void SamplePack::releaseFrames(const SampleZone &zone, uint64_t first, uint64_t last) const {
+#ifdef _WIN32
+    (void) zone;
+    (void) first;
+    (void) last;
+#else
+    const unsigned char *from, *to;
+    byteRange(zone, first, last, from, to);
+
+    // Only whole pages inside the range, so neighbouring frames still being streamed are not dropped
+    const uintptr_t page = (uintptr_t)pageSize();
+    uintptr_t begin = ((uintptr_t)from + page - 1) / page * page;
+    uintptr_t end = (uintptr_t)to / page * page;
+    if (end > begin) {
+        madvise((void *)begin, end - begin, MADV_DONTNEED);
+    }
+#endif
+}
+
+bool SamplePack::write(const std::string &path, int sampleRate, const std::vector<SamplePackEntry> &entries,
+                       SampleEncoding encoding, std::string &error) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        error = "could not create " + path;
+        return false;
+    }
+
+    FileHeader header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sampleRate = (uint32_t)sampleRate;
+    header.zoneCount = (uint32_t)entries.size();
+
+    // Zones are written one at a time and the table is filled in afterwards, so only one
+    // zone's compressed data is ever held in memory
+    std::vector<FileZone> fileZones(entries.size());
+    uint64_t offset = alignUp(sizeof(header) + entries.size() * sizeof(FileZone), DATA_ALIGNMENT);
+    bool ok = true;
+    std::vector<unsigned char> encoded;
+    for (size_t i = 0; ok && i < entries.size(); i++) {
+        const SamplePackEntry &entry = entries[i];
+        FileZone &fileZone = fileZones[i];
+        memset(&fileZone, 0, sizeof(fileZone));
+        fileZone.rootNote = (uint8_t)entry.rootNote;
+        fileZone.lowNote = (uint8_t)entry.lowNote;
+        fileZone.highNote = (uint8_t)entry.highNote;
+        fileZone.lowVelocity = (uint8_t)entry.lowVelocity;
+        fileZone.highVelocity = (uint8_t)entry.highVelocity;
+        fileZone.dataOffset = offset;
+        fileZone.frames = entry.samples.size();
+        fileZone.encoding = (uint32_t)encoding;
+
+        const unsigned char *bytes = (const unsigned char *)entry.samples.data();
+        size_t size = entry.samples.size() * sizeof(float);
+        if (encoding == SampleEncoding::Rice24) {
+            // Block offset table, then the blocks
+            uint64_t blocks = blockCount(entry.samples.size());
+            std::vector<uint64_t> offsets(blocks + 1);
+            encoded.assign(offsets.size() * sizeof(uint64_t), 0);
+            for (uint64_t block = 0; block < blocks; block++) {
+                offsets[block] = encoded.size();
+                uint64_t first = block * SampleCodec::BLOCK_FRAMES;
+                uint64_t frames = entry.samples.size() - first < (uint64_t)SampleCodec::BLOCK_FRAMES
+                                  ? entry.samples.size() - first : SampleCodec::BLOCK_FRAMES;
+                SampleCodec::encodeBlock(&entry.samples[first], (int)frames, encoded);
+            }
+            offsets[blocks] = encoded.size();
+            memcpy(encoded.data(), offsets.data(), offsets.size() * sizeof(uint64_t));
+            bytes = encoded.data();
+            size = encoded.size();
+        }
+
+        ok = seekTo(file, offset) && (size == 0 || fwrite(bytes, 1, size, file) == size);
+        offset = alignUp(offset + size, DATA_ALIGNMENT);
+    }
+
+    ok = ok && seekTo(file, 0) && fwrite(&header, sizeof(header), 1, file) == 1 &&
+         (fileZones.empty() || fwrite(fileZones.data(), sizeof(FileZone), fileZones.size(), file) == fileZones.size());
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        error = "could not write " + path;
+    }
+    return ok;
+}
@@ -0,0 +1,152 @@
+#ifndef GRAPHICS_SAMPLEPACK_H
+#define GRAPHICS_SAMPLEPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief How a zone's samples are stored in a pack.
+enum class SampleEncoding : uint32_t {
+    Float32 = 0, ///< raw mono floats
+    Rice24 = 1   ///< SampleCodec blocks behind a table of block offsets
+};
+
+/**
+ * @brief One recorded sample and the keys and velocities it covers.
+ * @details data points into the memory-mapped pack and is only read, through SamplePack::readFrames(),
+ * by the streaming thread. The first headFrames frames are also decoded to head, which stays in RAM so
+ * a note can start before the streamer has read anything.
+ */
+struct SampleZone {
+    int rootNote;
+    int lowNote;
+    int highNote;
+    int lowVelocity;
+    int highVelocity;
+
+    /// @brief The sample's length in frames.
+    uint64_t frames;
+
+    SampleEncoding encoding;
+
+    /// @brief The whole sample in the mapped file. For Rice24 zones, starts with blockCount + 1 offsets.
+    const unsigned char *data;
+
+    /// @brief A resident, decoded copy of the sample's first frames.
+    /// @details Covers whole codec blocks for compressed zones, so streaming always starts on a block.
+    const float *head;
+    uint64_t headFrames;
+};
+
+/// @brief A sample to store in a pack, used when building one.
+struct SamplePackEntry {
+    int rootNote;
+    int lowNote;
+    int highNote;
+    int lowVelocity;
+    int highVelocity;
+    std::vector<float> samples;
+};
+
+/**
+ * @brief A multisampled instrument stored in one file and memory-mapped rather than loaded.
+ * @details The file holds a header, a zone table and each zone's mono samples, every zone starting on
+ * a page boundary. Samples are stored as floats or compressed by SampleCodec. Only the zone table and
+ * each zone's first HEAD_SECONDS are decoded into memory. The rest is read from the mapping by a SampleStreamer, which releases pages once it has
+ * copied them, so the resident set stays small however large the pack is.
+ *
+ * Samples are stored little-endian, which is what every supported CPU uses natively.
+ */
+class SamplePack {
+public:
+    /// @brief How much of each sample is kept resident so notes can start at once.
+    static constexpr double HEAD_SECONDS = 0.1;
+
+    /// @brief The number of velocities a zone can be picked by.
+    static constexpr int NUM_VELOCITIES = 128;
+
+    SamplePack() = default;
+
+    /// @brief Destroy the SamplePack object and unmap the file
+    ~SamplePack();
+
+    SamplePack(const SamplePack&) = delete;
+    SamplePack& operator=(const SamplePack&) = delete;
+
+    /// @brief Maps a pack file and copies the heads of its samples into memory.
+    /// @param path The pack to open
+    /// @param error Receives a description of the problem if the pack could not be opened
+    /// @return true if the pack was opened
+    bool open(const std::string &path, std::string &error);
+
+    /// @brief Unmaps the file. Nothing may be playing from the pack.
+    void close();
+
+    bool isOpen() const;
+
+    /// @brief The zone to play for a key, or null if no zone covers it.
+    /// @details A table lookup, safe to call from the audio thread.
+    const SampleZone *findZone(int note, int velocity) const;
+
+    /// @brief The rate the samples were recorded at.
+    double getSampleRate() const;
+
+    size_t getZoneCount() const;
+
+    const SampleZone &getZone(size_t index) const;
+
+    /// @brief The bytes held in memory for the zone table and sample heads.
+    size_t getResidentBytes() const;
+
+    /// @brief The mapped file, or null if no pack is open. Its pages come and go as the streamer reads them.
+    const void *getMapping() const;
+
+    /// @brief The size of the mapped file in bytes.
+    size_t getMappingSize() const;
+
+    /// @brief Decodes frames [first, first + count) of a zone from the mapped file.
+    /// @details Reads the mapping, so it may block on disk. Streaming thread only; never call it from the audio thread.
+    /// Compressed zones decode fastest when first is a multiple of SampleCodec::BLOCK_FRAMES.
+    void readFrames(const SampleZone &zone, uint64_t first, uint64_t count, float *out) const;
+
+    /// @brief Tells the OS it may drop the mapped pages holding frames [first, last) of a zone.
+    /// @details Called by the streamer once it has copied them. The pages are read back from disk if needed again.
+    void releaseFrames(const SampleZone &zone, uint64_t first, uint64_t last) const;
+
+    /// @brief Writes a pack file.
+    /// @param path The file to write
+    /// @param sampleRate The rate the samples were recorded at
+    /// @param entries The zones and their samples
+    /// @param encoding How to store the samples
+    /// @param error Receives a description of the problem if the pack could not be written
+    /// @return true if the file was written
+    static bool write(const std::string &path, int sampleRate, const std::vector<SamplePackEntry> &entries,
+                      SampleEncoding encoding, std::string &error);
+
+private:
+    /// @brief Fills zoneLookup from the zones' key and velocity ranges.
+    void buildLookup();
+
+    /// @brief The byte range in the mapping that holds frames [first, last) of a zone.
+    void byteRange(const SampleZone &zone, uint64_t first, uint64_t last, const unsigned char *&begin,
+                   const unsigned char *&end) const;
+
+    const unsigned char *mapping = nullptr;
+    size_t mappingSize = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+
+    double sampleRate = 0;
+    std::vector<SampleZone> zones;
+
+    /// @brief Every zone's head, back to back.
+    std::vector<float> heads;
+
+    /// @brief The index into zones for every note and velocity, or -1.
+    std::vector<int16_t> zoneLookup;
+};
+
+#endif //GRAPHICS_SAMPLEPACK_H
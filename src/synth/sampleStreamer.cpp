@@ -0,0 +1,118 @@
+#include "sampleStreamer.h"
+#include "sampleCodec.h"
+
+#include <chrono>
+
+static_assert(SampleStreamer::RING_FRAMES % SampleCodec::BLOCK_FRAMES == 0, "rings must hold whole codec blocks");
+
+namespace {
+
+/// @brief How long the streaming thread sleeps when every ring is full.
+constexpr auto IDLE_SLEEP = std::chrono::milliseconds(2);
+
+} // namespace
+
+SampleStreamer::SampleStreamer(const SamplePack &pack)
+        : pack(pack), streams(new Stream[MAX_STREAMS]) {
+    thread = std::thread(&SampleStreamer::run, this);
+}
+
+SampleStreamer::~SampleStreamer() {
+    running.store(false, std::memory_order_relaxed);
+    thread.join();
+}
+
+int SampleStreamer::startStream(const SampleZone *zone) {
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        int index = (nextStream + i) % MAX_STREAMS;
+        Stream &stream = streams[index];
+        if (stream.state.load(std::memory_order_acquire) != Free) {
+            continue;
+        }
+        stream.zone = zone;
+        stream.readPosition.store(0, std::memory_order_relaxed);
+        stream.state.store(Starting, std::memory_order_release);
+        nextStream = (index + 1) % MAX_STREAMS;
+        return index;
+    }
+    return -1;
+}
+
+void SampleStreamer::stopStream(int stream) {
+    streams[stream].state.store(Stopping, std::memory_order_release);
+}
+
+uint64_t SampleStreamer::available(int stream) const {
+    return streams[stream].writePosition.load(std::memory_order_acquire);
+}
+
+void SampleStreamer::consume(int stream, uint64_t frame) {
+    streams[stream].readPosition.store(frame, std::memory_order_release);
+}
+
+uint64_t SampleStreamer::getUnderruns() const {
+    return underruns.load(std::memory_order_relaxed);
+}
+
+void SampleStreamer::recordUnderrun() {
+    underruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SampleStreamer::run() {
+    while (running.load(std::memory_order_relaxed)) {
+        bool busy = false;
+        for (int i = 0; i < MAX_STREAMS; i++) {
+            Stream &stream = streams[i];
+            int state = stream.state.load(std::memory_order_acquire);
+            if (state == Stopping) {
+                // The voice has let go; reset the ring before the stream can be claimed again
+                stream.writePosition.store(0, std::memory_order_relaxed);
+                stream.state.store(Free, std::memory_order_release);
+            } else if (state == Starting) {
+                // The voice may already have stopped it again, in which case it is picked up next pass
+                int expected = Starting;
+                if (stream.state.compare_exchange_strong(expected, Streaming, std::memory_order_acq_rel)) {
+                    busy |= fill(stream);
+                }
+            } else if (state == Streaming) {
+                busy |= fill(stream);
+            }
+        }
+        if (!busy) {
+            std::this_thread::sleep_for(IDLE_SLEEP);
+        }
+    }
+}
+
+bool SampleStreamer::fill(Stream &stream) {
+    const SampleZone &zone = *stream.zone;
+    uint64_t written = stream.writePosition.load(std::memory_order_relaxed);
+    uint64_t read = stream.readPosition.load(std::memory_order_acquire);
+    uint64_t first = zone.headFrames + written;
+    if (first >= zone.frames) {
+        return false;
+    }
+
+    uint64_t space = RING_FRAMES - (written - read);
+    uint64_t count = zone.frames - first;
+    count = count < space ? count : space;
+    count = count < CHUNK_FRAMES ? count : CHUNK_FRAMES;
+    // Compressed zones stream whole blocks, so no block is decoded twice. Heads end on a block boundary.
+    if (zone.encoding != SampleEncoding::Float32 && first + count < zone.frames) {
+        count -= count % SampleCodec::BLOCK_FRAMES;
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    // Read in at most two pieces around the end of the ring
+    uint64_t start = written & (RING_FRAMES - 1);
+    uint64_t firstPiece = RING_FRAMES - start < count ? RING_FRAMES - start : count;
+    pack.readFrames(zone, first, firstPiece, &stream.ring[start]);
+    pack.readFrames(zone, first + firstPiece, count - firstPiece, &stream.ring[0]);
+    stream.writePosition.store(written + count, std::memory_order_release);
+
+    // The frames are in the ring now, so the mapped pages behind them can go
+    pack.releaseFrames(zone, first, first + count);
+    return true;
+}
@@ -0,0 +1,103 @@
+#ifndef GRAPHICS_SAMPLESTREAMER_H
+#define GRAPHICS_SAMPLESTREAMER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "samplePack.h"
+
+/**
+ * @brief Reads sample data ahead of playback on a background thread, so the audio thread never touches the mapped pack.
+ * @details Each playing sample gets a stream: a ring buffer that the streaming thread fills from the mapped
+ * file while the audio thread reads it. A stream covers the sample from the end of its resident head, which
+ * gives the streamer HEAD_SECONDS to catch up after a note starts.
+ *
+ * Streams move through Free, Starting, Streaming and Stopping. The audio thread claims free streams and
+ * marks them stopping; only the streaming thread hands them back, once it has let go of the ring. Nothing
+ * on the audio side locks, allocates or reads from the pack.
+ */
+class SampleStreamer {
+public:
+    /// @brief The number of samples that can stream at once.
+    static constexpr int MAX_STREAMS = 256;
+
+    /// @brief Frames buffered ahead per stream (about 370 ms at 44.1 kHz). A power of two and a whole number of codec blocks.
+    static constexpr uint64_t RING_FRAMES = 16384;
+
+    /// @brief The most frames copied into one stream before moving on to the next.
+    static constexpr uint64_t CHUNK_FRAMES = 4096;
+
+    /// @brief Starts the streaming thread.
+    /// @param pack The pack streams read from. Must outlive the streamer.
+    explicit SampleStreamer(const SamplePack &pack);
+
+    /// @brief Stops and joins the streaming thread.
+    ~SampleStreamer();
+
+    SampleStreamer(const SampleStreamer&) = delete;
+    SampleStreamer& operator=(const SampleStreamer&) = delete;
+
+    /// @brief Claims a stream for a zone. Audio thread only.
+    /// @return the stream, or -1 if every stream is busy
+    int startStream(const SampleZone *zone);
+
+    /// @brief Gives a stream back. May be called from whichever thread renders the voice using it.
+    void stopStream(int stream);
+
+    /// @brief The number of frames past the zone's head that have been streamed so far.
+    uint64_t available(int stream) const;
+
+    /// @brief A streamed frame. frame counts from the end of the zone's head and must be below available().
+    float sampleAt(int stream, uint64_t frame) const {
+        return streams[stream].ring[frame & (RING_FRAMES - 1)];
+    }
+
+    /// @brief count consecutive streamed frames from frame, or null if they wrap around the end of the ring.
+    const float *framesAt(int stream, uint64_t frame, uint64_t count) const {
+        uint64_t index = frame & (RING_FRAMES - 1);
+        return index + count <= RING_FRAMES ? &streams[stream].ring[index] : nullptr;
+    }
+
+    /// @brief Tells the streamer that frames before frame (counted like sampleAt()) will not be read again.
+    void consume(int stream, uint64_t frame);
+
+    /// @brief The number of times a voice needed frames that had not been streamed yet.
+    uint64_t getUnderruns() const;
+
+    /// @brief Counts a stream that fell behind. Called by the voice that noticed.
+    void recordUnderrun();
+
+private:
+    enum State { Free, Starting, Streaming, Stopping };
+
+    struct Stream {
+        std::atomic<int> state{Free};
+        /// @brief Set by the audio thread before it marks the stream Starting.
+        const SampleZone *zone = nullptr;
+        /// @brief Frames written past the head. Only the streaming thread writes it.
+        std::atomic<uint64_t> writePosition{0};
+        /// @brief Frames the voice is done with. Only the voice writes it.
+        std::atomic<uint64_t> readPosition{0};
+        float ring[RING_FRAMES];
+    };
+
+    /// @brief The streaming thread's loop.
+    void run();
+
+    /// @brief Copies the next chunk of a stream's zone into its ring.
+    /// @return true if anything was copied
+    bool fill(Stream &stream);
+
+    const SamplePack &pack;
+    /// @brief Allocated once. Ring pages are only touched, and so only become resident, once a stream uses them.
+    std::unique_ptr<Stream[]> streams;
+    /// @brief Where startStream() starts looking for a free stream.
+    int nextStream = 0;
+    std::atomic<uint64_t> underruns{0};
+    std::atomic<bool> running{true};
+    std::thread thread;
+};
+
+#endif //GRAPHICS_SAMPLESTREAMER_H
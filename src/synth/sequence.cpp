@@ -0,0 +1,25 @@
+#include "sequence.h"
+
+#include <algorithm>
+
+Sequence::Sequence(const std::vector<SequenceNote> &notes) {
+    events.reserve(2 * notes.size());
+    for (const SequenceNote &note : notes) {
+        events.push_back(Event{note.start, NoteEvent::NoteOn, note.note, note.velocity});
+        events.push_back(Event{note.start + note.duration, NoteEvent::NoteOff, note.note, 0});
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+        if (a.time != b.time) {
+            return a.time < b.time;
+        }
+        return a.type == NoteEvent::NoteOff && b.type != NoteEvent::NoteOff;
+    });
+}
+
+const std::vector<Sequence::Event> &Sequence::getEvents() const {
+    return events;
+}
+
+double Sequence::getLength() const {
+    return events.empty() ? 0.0 : events.back().time;
+}
@@ -0,0 +1,57 @@
+#ifndef GRAPHICS_SEQUENCE_H
+#define GRAPHICS_SEQUENCE_H
+
+#include <vector>
+
+#include "noteEvent.h"
+
+/// @brief One note of a song, timed from the start of the song.
+struct SequenceNote {
+    /// @brief When the key goes down, in seconds.
+    double start;
+
+    /// @brief How long the key stays down, in seconds.
+    double duration;
+
+    /// @brief The MIDI note.
+    int note;
+
+    /// @brief How hard the key is struck, 1 to 127.
+    int velocity = 100;
+};
+
+/**
+ * @brief A song compiled into the note-ons and note-offs the synth plays, sorted by time.
+ * @details Built once, off the audio thread. The synth converts the times to sample positions when the
+ * sequence is set, and plays it from inside the audio callback with a cursor, so each buffer only looks at
+ * the events due in it.
+ */
+class Sequence {
+public:
+    /// @brief One note-on or note-off, in seconds from the start of the song.
+    struct Event {
+        double time;
+        NoteEvent::Type type;
+        int note;
+        int velocity;
+    };
+
+    /// @brief An empty sequence.
+    Sequence() = default;
+
+    /// @brief Compiles notes into events.
+    /// @details A note-off at the same time as a note-on is ordered first, so a note played twice in a row
+    /// is struck again instead of being cut off.
+    explicit Sequence(const std::vector<SequenceNote> &notes);
+
+    /// @brief The events, sorted by time.
+    const std::vector<Event> &getEvents() const;
+
+    /// @brief When the last event happens, in seconds.
+    double getLength() const;
+
+private:
+    std::vector<Event> events;
+};
+
+#endif //GRAPHICS_SEQUENCE_H
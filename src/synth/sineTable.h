@@ -0,0 +1,47 @@
+#ifndef GRAPHICS_SINETABLE_H
+#define GRAPHICS_SINETABLE_H
+
+#include <array>
+
+#include "renderKernel.h"
+
+namespace sine_table_detail {
+
+constexpr double PI = 3.14159265358979323846;
+
+/// @brief sin(x) for x in [0, pi/2] by Taylor series. Accurate to double precision over that range.
+constexpr double quarterSin(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 13; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+/// @brief sin(2 * pi * i / WAVETABLE_SIZE) using quarter-wave symmetry so the series only sees small angles.
+constexpr double cycleSin(int i) {
+    const int quarter = WAVETABLE_SIZE / 4;
+    const double step = 2.0 * PI / WAVETABLE_SIZE;
+    if (i < quarter) return quarterSin(i * step);
+    if (i < 2 * quarter) return quarterSin((2 * quarter - i) * step);
+    if (i < 3 * quarter) return -quarterSin((i - 2 * quarter) * step);
+    return -quarterSin((WAVETABLE_SIZE - i) * step);
+}
+
+constexpr std::array<double, WAVETABLE_SIZE> makeSineCycle() {
+    std::array<double, WAVETABLE_SIZE> cycle{};
+    for (int i = 0; i < WAVETABLE_SIZE; i++) {
+        cycle[i] = cycleSin(i);
+    }
+    return cycle;
+}
+
+} // namespace sine_table_detail
+
+/// @brief One cycle of a sine wave in double precision, generated at compile time.
+/// @details Harmonic h at sample i is SINE_CYCLE[(h * i) mod WAVETABLE_SIZE], which is how the wavetable bank sums partials.
+inline constexpr std::array<double, WAVETABLE_SIZE> SINE_CYCLE = sine_table_detail::makeSineCycle();
+
+#endif //GRAPHICS_SINETABLE_H
@@ -0,0 +1,105 @@
+#ifndef GRAPHICS_SNAPSHOTSTORE_H
+#define GRAPHICS_SNAPSHOTSTORE_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Hands immutable snapshots of some state from control threads to one real-time reader, read-copy-update style.
+ * @details Writers build a whole new snapshot, then publish it with a single atomic pointer store, so the reader
+ * never sees half of a change and never waits for a writer. The reader calls acquire() once per pass (for the synth,
+ * at the start of every buffer) and keeps using what it got until the next acquire(), so every read within a pass
+ * agrees.
+ *
+ * Before using a snapshot the reader announces it in a hazard slot and checks it is still the newest. Writers free
+ * every snapshot that is neither the newest nor announced, so a snapshot is never freed under the reader, and
+ * all allocation and freeing happens on the writers' threads. Writers take a mutex among themselves only; the
+ * reader never touches it.
+ *
+ * @tparam T The snapshot type. Must be copyable for update() and read().
+ */
+template <typename T>
+class SnapshotStore {
+public:
+    /// @brief Makes a snapshot the newest. Writer threads only.
+    /// @details Frees the snapshots the reader has moved past.
+    void publish(std::unique_ptr<T> snapshot) {
+        std::lock_guard<std::mutex> lock(writerLock);
+        published.store(snapshot.get(), std::memory_order_seq_cst);
+        snapshots.push_back(std::move(snapshot));
+        reclaimLocked();
+    }
+
+    /// @brief Publishes a copy of a snapshot. Writer threads only.
+    void publish(const T &snapshot) {
+        publish(std::make_unique<T>(snapshot));
+    }
+
+    /// @brief Copies the newest snapshot, lets change() edit the copy, then publishes it. Writer threads only.
+    /// @details Writers are serialized, so two updates to different fields never lose either one. Something must
+    /// have been published first.
+    template <typename Change>
+    void update(Change change) {
+        std::lock_guard<std::mutex> lock(writerLock);
+        std::unique_ptr<T> snapshot = std::make_unique<T>(*published.load(std::memory_order_relaxed));
+        change(*snapshot);
+        published.store(snapshot.get(), std::memory_order_seq_cst);
+        snapshots.push_back(std::move(snapshot));
+        reclaimLocked();
+    }
+
+    /// @brief A copy of the newest snapshot, for getters. Writer threads only. Something must have been published first.
+    T read() const {
+        std::lock_guard<std::mutex> lock(writerLock);
+        return *published.load(std::memory_order_relaxed);
+    }
+
+    /// @brief The newest snapshot, or null if nothing has been published. Reader thread only.
+    /// @details Never blocks or allocates. The snapshot stays valid until the reader's next acquire().
+    const T *acquire() {
+        T *snapshot = published.load(std::memory_order_seq_cst);
+        for (;;) {
+            announced.store(snapshot, std::memory_order_seq_cst);
+            // A writer that freed it did so before the announcement, and published something newer first
+            T *newest = published.load(std::memory_order_seq_cst);
+            if (newest == snapshot) {
+                return snapshot;
+            }
+            snapshot = newest;
+        }
+    }
+
+    /// @brief Frees the snapshots the reader has moved past since the last publish. Writer threads only.
+    /// @details publish() already does this; calling it now and then from a control thread also frees the snapshot
+    /// the reader was still using when the last one was published.
+    void reclaim() {
+        std::lock_guard<std::mutex> lock(writerLock);
+        reclaimLocked();
+    }
+
+private:
+    void reclaimLocked() {
+        T *keep = published.load(std::memory_order_relaxed);
+        T *inUse = announced.load(std::memory_order_seq_cst);
+        snapshots.erase(std::remove_if(snapshots.begin(), snapshots.end(), [&](const std::unique_ptr<T> &snapshot) {
+            return snapshot.get() != keep && snapshot.get() != inUse;
+        }), snapshots.end());
+    }
+
+    /// @brief Serializes writers. Never taken by the reader.
+    mutable std::mutex writerLock;
+
+    /// @brief Every snapshot that may still be read.
+    std::vector<std::unique_ptr<T>> snapshots;
+
+    /// @brief The newest snapshot.
+    std::atomic<T *> published{nullptr};
+
+    /// @brief The snapshot the reader is using.
+    std::atomic<T *> announced{nullptr};
+};
+
+#endif //GRAPHICS_SNAPSHOTSTORE_H
@@ -0,0 +1,83 @@
+#ifndef GRAPHICS_SPSCQUEUE_H
+#define GRAPHICS_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief A wait-free single-producer/single-consumer ring buffer.
+ * @details One thread may call push() and one other thread may call pop(). Neither call
+ * blocks or allocates, so the consumer side is safe to use from an audio callback.
+ * The storage is a fixed array of Capacity slots allocated with the queue.
+ *
+ * @tparam T The element type. Must be trivially copyable.
+ * @tparam Capacity The number of slots. Must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    /// @brief Adds an element to the back of the queue. Producer thread only.
+    /// @param item The element to copy into the queue
+    /// @return false if the queue is full and the element was dropped
+    bool push(const T &item) {
+        const size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - cachedHead == Capacity) {
+            cachedHead = this->head.load(std::memory_order_acquire);
+            if (tail - cachedHead == Capacity) {
+                return false;
+            }
+        }
+        slots[tail & MASK] = item;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Removes the element at the front of the queue. Consumer thread only.
+    /// @param item Receives the element if there was one
+    /// @return false if the queue was empty
+    bool pop(T &item) {
+        const size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = this->tail.load(std::memory_order_acquire);
+            if (head == cachedTail) {
+                return false;
+            }
+        }
+        item = slots[head & MASK];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Returns a pointer to the element at the front of the queue without removing it. Consumer thread only.
+    /// @return nullptr if the queue is empty
+    const T *peek() {
+        const size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = this->tail.load(std::memory_order_acquire);
+            if (head == cachedTail) {
+                return nullptr;
+            }
+        }
+        return &slots[head & MASK];
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t CACHE_LINE = 64;
+
+    /// @brief Next slot to read. Written by the consumer.
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};
+    /// @brief The consumer's last seen value of tail, so it only touches the producer's line when the queue looks empty.
+    size_t cachedTail = 0;
+
+    /// @brief Next slot to write. Written by the producer.
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};
+    /// @brief The producer's last seen value of head, so it only touches the consumer's line when the queue looks full.
+    size_t cachedHead = 0;
+
+    alignas(CACHE_LINE) T slots[Capacity];
+};
+
+#endif //GRAPHICS_SPSCQUEUE_H
@@ -0,0 +1,349 @@
+#include "stringBank.h"
+
+#include <complex>
+#include <math.h>
+
+#include "denormals.h"
+#include "renderKernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SYNTH_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace {
+
+/// @brief How long a string with its damper lifted takes to fall by 60 dB, at the bottom and the top of the keyboard.
+constexpr double BASS_RING_SECONDS = 15.0;
+constexpr double TREBLE_RING_SECONDS = 0.6;
+
+/// @brief How long a damped string takes to fall by 60 dB.
+constexpr double DAMPED_RING_SECONDS = 0.12;
+
+/// @brief The loop lowpass coefficient at the bottom and the top of the keyboard. Higher is darker.
+constexpr double BASS_LOWPASS = 0.3;
+constexpr double TREBLE_LOWPASS = 0.08;
+
+/// @brief How long the hammer stays on the string for the softest and the hardest strike.
+constexpr double SOFT_HAMMER_SECONDS = 0.003;
+constexpr double HARD_HAMMER_SECONDS = 0.0006;
+
+/// @brief The peak of the hammer pulse for the hardest strike.
+constexpr float HAMMER_GAIN = 1.0f;
+
+/// @brief How much of the bridge's motion reaches each string, as a fraction of the string's own loss per trip.
+/// @details Held below every string's loss, the coupled strings stay stable even with every damper lifted and every
+/// key struck; about twice this is where that case starts to grow.
+constexpr double BRIDGE_COUPLING = 0.3;
+
+/// @brief The pole of the highpass that keeps the bridge's DC out of the strings. Cuts below about 35 Hz at 44.1 kHz.
+constexpr float BRIDGE_HIGHPASS = 0.995f;
+
+/// @brief The gain applied to the bridge signal before it is mixed.
+constexpr float OUTPUT_GAIN = 0.25f;
+
+/// @brief The phase delay of a one-pole lowpass y = x + b (y1 - x) at angular frequency w, in samples.
+double lowpassDelay(double b, double w) {
+    return atan2(b * sin(w), 1.0 - b * cos(w)) / w;
+}
+
+/// @brief The phase delay of the allpass y = c x + x1 - c y1 at angular frequency w, in samples.
+double allpassDelay(double c, double w) {
+    std::complex<double> z = std::polar(1.0, -w);
+    return -std::arg((c + z) / (1.0 + c * z)) / w;
+}
+
+/// @brief The allpass coefficient whose phase delay at w is delay samples. delay must be in [0.5, 1.5).
+double allpassForDelay(double delay, double w) {
+    // The delay falls as the coefficient rises, so bisect
+    double low = -0.999, high = 0.999;
+    for (int i = 0; i < 50; i++) {
+        double middle = 0.5 * (low + high);
+        if (allpassDelay(middle, w) > delay) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return 0.5 * (low + high);
+}
+
+/// @brief A string's pitch in equal temperament with A4 at 440 Hz.
+double equalTemperedFrequency(int note) {
+    return 440.0 * pow(2.0, (note - 69) / 12.0);
+}
+
+/// @brief A string's loop lowpass coefficient, which depends only on where it is on the keyboard.
+double loopLowpass(int string) {
+    double position = string / (double)(StringBank::STRING_COUNT - 1);
+    return BASS_LOWPASS + (TREBLE_LOWPASS - BASS_LOWPASS) * position;
+}
+
+/// @brief The longest delay a string's line is built for: an octave below equal temperament.
+int maximumDelay(double sampleRate, int string) {
+    return (int)ceil(2.0 * sampleRate / equalTemperedFrequency(StringBank::LOWEST_NOTE + string));
+}
+
+} // namespace
+
+StringBank::StringBank(double sampleRate) : sampleRate(sampleRate), groups(new StringGroup[GROUP_COUNT]()) {
+    for (int string = 0; string < GROUP_COUNT * LANES; string++) {
+        StringGroup &group = groups[string / LANES];
+        int lane = string % LANES;
+        // Padding lanes stay silent
+        group.delay[lane] = 1;
+        group.hammerPhase[lane] = 1.0f;
+        if (string < STRING_COUNT) {
+            group.lowpass[lane] = (float)loopLowpass(string);
+        }
+    }
+
+    // Each group's lines are as long as its longest string could be tuned, rounded up to a power of two
+    size_t offsets[GROUP_COUNT];
+    size_t total = 0;
+    for (int g = 0; g < GROUP_COUNT; g++) {
+        int longest = 0;
+        for (int lane = 0; lane < LANES && g * LANES + lane < STRING_COUNT; lane++) {
+            int delay = maximumDelay(sampleRate, g * LANES + lane);
+            longest = delay > longest ? delay : longest;
+        }
+        int length = 1;
+        while (length <= longest) {
+            length <<= 1;
+        }
+        groups[g].lineMask = length - 1;
+        offsets[g] = total;
+        total += (size_t)length * LANES;
+    }
+    lineMemory.assign(total, 0.0f);
+    for (int g = 0; g < GROUP_COUNT; g++) {
+        groups[g].line = lineMemory.data() + offsets[g];
+    }
+
+    Tuning tuning;
+    tune(sampleRate, nullptr, tuning);
+    retune(tuning);
+    for (int string = 0; string < STRING_COUNT; string++) {
+        groups[string / LANES].loopGain[string % LANES] = dampedGain[string];
+    }
+
+#ifdef SYNTH_X86
+    if (cpuSupportsAvx2()) {
+        renderStrings = &StringBank::renderAvx2;
+        kernelName = "avx2";
+        return;
+    }
+#endif
+    renderStrings = &StringBank::renderScalar;
+    kernelName = "scalar";
+}
+
+void StringBank::tune(double sampleRate, const double *frequencies, Tuning &tuning) {
+    double minimumLoss = 1.0;
+    tuning.longestDelay = 0;
+    for (int string = 0; string < STRING_COUNT; string++) {
+        int note = LOWEST_NOTE + string;
+        double frequency = frequencies != nullptr && frequencies[note] > 0.0 ? frequencies[note] : equalTemperedFrequency(note);
+        double position = string / (double)(STRING_COUNT - 1);
+        double period = sampleRate / frequency;
+        double w = 2.0 * M_PI * frequency / sampleRate;
+
+        // The loop is the delay line plus the lowpass's and the allpass's phase delays; the allpass makes up the fraction.
+        // Pitches past the ends of the line are held at them, keeping the fraction in the allpass's range.
+        double remaining = period - lowpassDelay(loopLowpass(string), w);
+        remaining = fmax(1.5, fmin(remaining, maximumDelay(sampleRate, string) + 0.5));
+        int delay = (int)floor(remaining - 0.5);
+        tuning.delay[string] = delay;
+        tuning.allpass[string] = (float)allpassForDelay(remaining - delay, w);
+        tuning.longestDelay = (unsigned long)delay > tuning.longestDelay ? (unsigned long)delay : tuning.longestDelay;
+
+        // Per trip around the loop, which takes one period
+        double ringSeconds = BASS_RING_SECONDS * pow(TREBLE_RING_SECONDS / BASS_RING_SECONDS, position);
+        tuning.heldGain[string] = (float)pow(10.0, -3.0 * period / (ringSeconds * sampleRate));
+        tuning.dampedGain[string] = note >= FIRST_UNDAMPED_NOTE
+                                    ? tuning.heldGain[string] : (float)pow(10.0, -3.0 * period / (DAMPED_RING_SECONDS * sampleRate));
+        minimumLoss = fmin(minimumLoss, 1.0 - tuning.heldGain[string]);
+    }
+    tuning.coupling = (float)(BRIDGE_COUPLING * minimumLoss);
+}
+
+void StringBank::retune(const Tuning &tuning) {
+    for (int string = 0; string < STRING_COUNT; string++) {
+        StringGroup &group = groups[string / LANES];
+        int lane = string % LANES;
+        bool damped = group.loopGain[lane] != heldGain[string];
+        heldGain[string] = tuning.heldGain[string];
+        dampedGain[string] = tuning.dampedGain[string];
+        group.loopGain[lane] = damped ? dampedGain[string] : heldGain[string];
+        group.delay[lane] = tuning.delay[string];
+        group.allpass[lane] = tuning.allpass[string];
+    }
+    coupling = tuning.coupling;
+    longestDelay = tuning.longestDelay;
+}
+
+bool StringBank::hasString(int note) {
+    return note >= LOWEST_NOTE && note < LOWEST_NOTE + STRING_COUNT;
+}
+
+void StringBank::strike(int note, int velocity) {
+    if (!hasString(note)) {
+        return;
+    }
+    int string = note - LOWEST_NOTE;
+    StringGroup &group = groups[string / LANES];
+    int lane = string % LANES;
+
+    float hardness = (velocity < 1 ? 1 : velocity > 127 ? 127 : velocity) / 127.0f;
+    // A pulse longer than half the period would cancel the fundamental, so treble strikes are kept short
+    double period = group.delay[lane] + 1.0;
+    double width = (SOFT_HAMMER_SECONDS + (HARD_HAMMER_SECONDS - SOFT_HAMMER_SECONDS) * hardness) * sampleRate;
+    width = fmax(2.0, fmin(width, 0.45 * period));
+    group.hammerPhase[lane] = 0.0f;
+    group.hammerStep[lane] = (float)(1.0 / width);
+    // The pulse is the change in a bump of this height, which peaks near HAMMER_GAIN
+    group.hammerAmplitude[lane] = (float)(HAMMER_GAIN * hardness * hardness * width / 4.0);
+    asleep = false;
+    silentFrames = 0;
+}
+
+void StringBank::setDamper(int note, bool damped) {
+    if (!hasString(note)) {
+        return;
+    }
+    int string = note - LOWEST_NOTE;
+    groups[string / LANES].loopGain[string % LANES] = damped ? dampedGain[string] : heldGain[string];
+}
+
+void StringBank::render(float *out, unsigned long frames) {
+    if (asleep) {
+        return;
+    }
+
+    // Decaying strings reach denormals long before they are inaudible. The audio thread normally flushes them
+    // already; this covers callers that do not.
+    float peak;
+    {
+        ScopedFlushToZero flushToZero;
+        peak = renderStrings(*this, out, frames);
+    }
+
+    // Sleep once the bridge has been silent for longer than a sample takes to travel any line.
+    // A strike resets the count, so a hammer still moving keeps the bank awake.
+    if (peak >= SILENCE) {
+        silentFrames = 0;
+    } else if ((silentFrames += frames) > longestDelay + frames) {
+        asleep = true;
+    }
+}
+
+const char *StringBank::getKernelName() const {
+    return kernelName;
+}
+
+float StringBank::renderScalar(StringBank &bank, float *out, unsigned long frames) {
+    float peak = 0.0f;
+    for (unsigned long i = 0; i < frames; i++) {
+        bank.bridgeMotion = bank.bridge - bank.previousBridge + BRIDGE_HIGHPASS * bank.bridgeMotion;
+        float drive = bank.coupling * bank.bridgeMotion;
+        float sum = 0.0f;
+        for (int g = 0; g < GROUP_COUNT; g++) {
+            StringGroup &group = bank.groups[g];
+            float *row = group.line + (size_t)group.writeIndex * LANES;
+            for (int lane = 0; lane < LANES; lane++) {
+                float delayed = group.line[(size_t)((group.writeIndex - group.delay[lane]) & group.lineMask) * LANES + lane];
+
+                float lowpassed = delayed + group.lowpass[lane] * (group.lowpassState[lane] - delayed);
+                group.lowpassState[lane] = lowpassed;
+                float damped = group.loopGain[lane] * lowpassed;
+                float tuned = group.allpass[lane] * (damped - group.allpassOutput[lane]) + group.allpassInput[lane];
+                group.allpassInput[lane] = damped;
+                group.allpassOutput[lane] = tuned;
+
+                // Feeding the change in a bump rather than the bump itself sums to exactly zero, so the hammer leaves no DC
+                float phase = group.hammerPhase[lane];
+                float bump = group.hammerAmplitude[lane] * 4.0f * phase * (1.0f - phase);
+                float hammer = bump - group.hammerPrevious[lane];
+                group.hammerPrevious[lane] = bump;
+                group.hammerPhase[lane] = fminf(phase + group.hammerStep[lane], 1.0f);
+
+                row[lane] = tuned + hammer + drive;
+                sum += tuned;
+            }
+            group.writeIndex = (group.writeIndex + 1) & group.lineMask;
+        }
+        bank.previousBridge = bank.bridge;
+        bank.bridge = sum;
+        peak = fmaxf(peak, fabsf(sum));
+        out[i] += OUTPUT_GAIN * sum;
+    }
+    return peak;
+}
+
+#ifdef SYNTH_X86
+
+TARGET_AVX2
+float StringBank::renderAvx2(StringBank &bank, float *out, unsigned long frames) {
+    float peak = 0.0f;
+    const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 four = _mm256_set1_ps(4.0f);
+
+    for (unsigned long i = 0; i < frames; i++) {
+        bank.bridgeMotion = bank.bridge - bank.previousBridge + BRIDGE_HIGHPASS * bank.bridgeMotion;
+        __m256 drive = _mm256_set1_ps(bank.coupling * bank.bridgeMotion);
+        __m256 sum = _mm256_setzero_ps();
+        for (int g = 0; g < GROUP_COUNT; g++) {
+            StringGroup &group = bank.groups[g];
+            __m256i position = _mm256_sub_epi32(_mm256_set1_epi32(group.writeIndex),
+                                                _mm256_load_si256((const __m256i *)group.delay));
+            position = _mm256_and_si256(position, _mm256_set1_epi32(group.lineMask));
+            __m256i index = _mm256_add_epi32(_mm256_slli_epi32(position, 3), laneIndex);
+            __m256 delayed = _mm256_i32gather_ps(group.line, index, 4);
+
+            __m256 state = _mm256_load_ps(group.lowpassState);
+            __m256 lowpassed = _mm256_add_ps(delayed, _mm256_mul_ps(_mm256_load_ps(group.lowpass), _mm256_sub_ps(state, delayed)));
+            _mm256_store_ps(group.lowpassState, lowpassed);
+            __m256 damped = _mm256_mul_ps(_mm256_load_ps(group.loopGain), lowpassed);
+            __m256 tuned = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(group.allpass),
+                                                         _mm256_sub_ps(damped, _mm256_load_ps(group.allpassOutput))),
+                                           _mm256_load_ps(group.allpassInput));
+            _mm256_store_ps(group.allpassInput, damped);
+            _mm256_store_ps(group.allpassOutput, tuned);
+
+            __m256 phase = _mm256_load_ps(group.hammerPhase);
+            __m256 bump = _mm256_mul_ps(_mm256_mul_ps(_mm256_load_ps(group.hammerAmplitude), four),
+                                        _mm256_mul_ps(phase, _mm256_sub_ps(one, phase)));
+            __m256 hammer = _mm256_sub_ps(bump, _mm256_load_ps(group.hammerPrevious));
+            _mm256_store_ps(group.hammerPrevious, bump);
+            _mm256_store_ps(group.hammerPhase, _mm256_min_ps(_mm256_add_ps(phase, _mm256_load_ps(group.hammerStep)), one));
+
+            _mm256_storeu_ps(group.line + (size_t)group.writeIndex * LANES, _mm256_add_ps(_mm256_add_ps(tuned, hammer), drive));
+            sum = _mm256_add_ps(sum, tuned);
+            group.writeIndex = (group.writeIndex + 1) & group.lineMask;
+        }
+
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        bank.previousBridge = bank.bridge;
+        bank.bridge = _mm_cvtss_f32(half);
+        peak = fmaxf(peak, fabsf(bank.bridge));
+        out[i] += OUTPUT_GAIN * bank.bridge;
+    }
+    return peak;
+}
+
+#else
+
+float StringBank::renderAvx2(StringBank &bank, float *out, unsigned long frames) {
+    return renderScalar(bank, out, frames);
+}
+
+#endif // SYNTH_X86
@@ -0,0 +1,145 @@
+#ifndef GRAPHICS_STRINGBANK_H
+#define GRAPHICS_STRINGBANK_H
+
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The 88 strings of a piano as digital waveguides, all ringing at once.
+ * @details Each string is a delay line closed by a loop filter: a one-pole lowpass for the losses that
+ * grow with frequency, a gain for how long the string rings, and a first-order allpass that supplies
+ * the fraction of a sample the integer delay cannot, so every string is tuned exactly.
+ * Striking a string feeds a short zero-mean hammer pulse into the loop. Harder strikes make the pulse
+ * shorter and brighter.
+ *
+ * The strings are never allocated or freed. Every string keeps ringing whether or not its key is
+ * down; a key only lifts the string's damper, which switches the string between its long and short
+ * decay. The strings also share a bridge: each one hears a little of what all the others play, so an
+ * undamped string picks up its harmonics from the notes played around it the way a real piano's do.
+ *
+ * Strings are stored in groups of eight with their delay lines interleaved, so one AVX2 register holds
+ * one sample of eight strings and a whole group advances with a gather, a handful of multiplies and one
+ * store. CPUs without AVX2 run the same steps one lane at a time. Once everything has died away the
+ * bank stops rendering until the next strike.
+ *
+ * All methods must be called from the audio thread.
+ */
+class StringBank {
+public:
+    /// @brief The MIDI note of the lowest string (A0).
+    static constexpr int LOWEST_NOTE = 21;
+
+    /// @brief The number of strings.
+    static constexpr int STRING_COUNT = 88;
+
+    /// @brief The number of strings updated together.
+    static constexpr int LANES = 8;
+
+    /// @brief Strings from this note up have no damper and ring out whether their key is down or not.
+    static constexpr int FIRST_UNDAMPED_NOTE = 89;
+
+    /// @brief What tuning every string to a pitch takes, worked out ahead of time so retuning costs the audio thread a copy.
+    struct Tuning {
+        int delay[STRING_COUNT];
+        float allpass[STRING_COUNT];
+        float heldGain[STRING_COUNT];
+        float dampedGain[STRING_COUNT];
+        float coupling;
+        unsigned long longestDelay;
+    };
+
+    /// @brief Builds the strings in equal temperament with A4 at 440 Hz, all silent with their dampers down.
+    /// @details Each line has room for its string to be tuned down to an octave below that.
+    /// @param sampleRate The rate the bank renders at
+    explicit StringBank(double sampleRate);
+
+    /// @brief Works out the strings' tuning for a set of pitches. Safe to call from any thread.
+    /// @param sampleRate The rate of the bank the tuning is for
+    /// @param frequencies Each MIDI note's frequency. Strings without one (0) keep equal temperament, and strings
+    /// tuned more than an octave below it are held there.
+    /// @param tuning Filled in
+    static void tune(double sampleRate, const double *frequencies, Tuning &tuning);
+
+    /// @brief Retunes every string. Ringing strings carry on at their new pitch.
+    /// @param tuning Worked out by tune() at the bank's rate
+    void retune(const Tuning &tuning);
+
+    /// @brief Whether a note has a string.
+    static bool hasString(int note);
+
+    /// @brief Strikes a string with the hammer. Adds to whatever the string was already playing.
+    /// @param note The MIDI note of the string
+    /// @param velocity How hard the key was struck, 1 to 127
+    void strike(int note, int velocity);
+
+    /// @brief Lowers or lifts a string's damper.
+    void setDamper(int note, bool damped);
+
+    /// @brief Adds the strings' output to a mono buffer. Never blocks or allocates.
+    void render(float *out, unsigned long frames);
+
+    /// @brief The instruction set the strings are rendered with.
+    const char *getKernelName() const;
+
+private:
+    static constexpr int GROUP_COUNT = (STRING_COUNT + LANES - 1) / LANES;
+
+    /// @brief Eight strings' state, one lane each.
+    struct alignas(32) StringGroup {
+        float loopGain[LANES];
+        float lowpass[LANES];
+        float lowpassState[LANES];
+        float allpass[LANES];
+        float allpassInput[LANES];
+        float allpassOutput[LANES];
+        float hammerPhase[LANES];
+        float hammerStep[LANES];
+        float hammerAmplitude[LANES];
+        float hammerPrevious[LANES];
+        int delay[LANES];
+
+        /// @brief The delay lines, interleaved: row i holds sample i of all eight lines.
+        float *line;
+        int lineMask;
+        int writeIndex;
+    };
+
+    /// @brief Renders the strings and returns the loudest sample of the bridge.
+    typedef float (*RenderStringsFunction)(StringBank &bank, float *out, unsigned long frames);
+
+    static float renderScalar(StringBank &bank, float *out, unsigned long frames);
+    static float renderAvx2(StringBank &bank, float *out, unsigned long frames);
+
+    /// @brief The bridge level below which the strings count as silent.
+    static constexpr float SILENCE = 1e-6f;
+
+    double sampleRate;
+    std::unique_ptr<StringGroup[]> groups;
+    std::vector<float> lineMemory;
+
+    /// @brief Each string's loop gain with its damper lifted and lowered.
+    float heldGain[STRING_COUNT] = {};
+    float dampedGain[STRING_COUNT] = {};
+
+    /// @brief How strongly each string hears the bridge.
+    float coupling;
+
+    /// @brief The bridge signal of the previous sample, and the one before it.
+    float bridge = 0.0f;
+    float previousBridge = 0.0f;
+
+    /// @brief The bridge signal with its DC removed, which is what drives the strings.
+    float bridgeMotion = 0.0f;
+
+    /// @brief True once everything has died away, until the next strike.
+    bool asleep = true;
+
+    /// @brief How long the bridge has been silent. What is still travelling down a line takes up to the longest delay to reach it.
+    unsigned long silentFrames = 0;
+    unsigned long longestDelay = 0;
+
+    RenderStringsFunction renderStrings;
+    const char *kernelName;
+};
+
+#endif //GRAPHICS_STRINGBANK_H
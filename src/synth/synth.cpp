@@ -0,0 +1,883 @@
+#include "synth.h"
+
+#include <math.h>
+
+Synth::Synth() : Synth(WavetableBank::shared(), selectRenderKernel()) {}
+
+Synth::Synth(const RenderKernel &kernel) : Synth(WavetableBank::shared(), kernel) {}
+
+Synth::Synth(const WavetableBank &bank, const RenderKernel &kernel)
+        : bank(bank), resampler(PolyphaseResampler::shared()), kernel(kernel), strings(DEFAULT_SAMPLE_RATE),
+          limiter(DEFAULT_SAMPLE_RATE) {
+    // The piano's keys from left to right; notes beyond its ends sit at the edges
+    for (int note = 0; note < NUM_NOTES; note++) {
+        float pan = (note - 64.5f) / 43.5f;
+        notePans[note].store(pan < -1.0f ? -1.0f : (pan > 1.0f ? 1.0f : pan), std::memory_order_relaxed);
+    }
+    updateRateTables();
+
+    std::unique_ptr<ParameterSnapshot> snapshot = std::make_unique<ParameterSnapshot>();
+    deriveParameters(*snapshot);
+    parameterSnapshots.publish(std::move(snapshot));
+    std::unique_ptr<NoteTable> table = std::make_unique<NoteTable>();
+    tuneNoteTable(*table);
+    noteTables.publish(std::move(table));
+    acquireSnapshots();
+}
+
+void Synth::setSampleRate(double sampleRate) {
+    if (sampleRate <= 0.0 || sampleRate == this->sampleRate) {
+        return;
+    }
+    // A song already under way carries on from the same point in time
+    sequencePosition = (uint64_t)(sequencePosition * sampleRate / this->sampleRate + 0.5);
+    this->sampleRate = sampleRate;
+    compileSequence();
+    strings = StringBank(sampleRate);
+    limiter = LookaheadLimiter(sampleRate);
+    updateRateTables();
+    parameterSnapshots.update([this](ParameterSnapshot &snapshot) { deriveParameters(snapshot); });
+    noteTables.update([this](NoteTable &table) { tuneNoteTable(table); });
+    // The new strings start out in equal temperament; picking the table up again retunes them
+    noteTable = nullptr;
+    acquireSnapshots();
+    buildReverb();
+}
+
+double Synth::getSampleRate() const {
+    return sampleRate;
+}
+
+void Synth::updateRateTables() {
+    sampleEnvelope = EnvelopeCoefficients::fromSettings(SAMPLE_ENVELOPE, sampleRate);
+
+    if (samplePack != nullptr) {
+        // A zone played at its root's equal-tempered pitch reads one recorded frame per frame of the pack's rate
+        double rateRatio = samplePack->getSampleRate() / sampleRate;
+        for (int root = 0; root < NUM_NOTES; root++) {
+            zoneIncrementScales[root] = rateRatio * 4294967296.0 / noteToFrequency(root);
+        }
+    }
+}
+
+void Synth::setParameters(const Parameters &parameters) {
+    std::unique_ptr<ParameterSnapshot> snapshot = std::make_unique<ParameterSnapshot>();
+    snapshot->settings = parameters;
+    deriveParameters(*snapshot);
+    parameterSnapshots.publish(std::move(snapshot));
+}
+
+Synth::Parameters Synth::getParameters() const {
+    return parameterSnapshots.read().settings;
+}
+
+void Synth::reclaimSnapshots() {
+    parameterSnapshots.reclaim();
+    noteTables.reclaim();
+}
+
+void Synth::setVolume(float volume) {
+    parameterSnapshots.update([volume](ParameterSnapshot &snapshot) {
+        snapshot.settings.volume = volume > 0.0f ? volume : 0.0f;
+    });
+}
+
+float Synth::getVolume() const {
+    return getParameters().volume;
+}
+
+void Synth::setEnvelope(const EnvelopeSettings &envelope) {
+    parameterSnapshots.update([this, &envelope](ParameterSnapshot &snapshot) {
+        snapshot.settings.envelope = envelope;
+        deriveParameters(snapshot);
+    });
+}
+
+EnvelopeSettings Synth::getEnvelope() const {
+    return getParameters().envelope;
+}
+
+void Synth::deriveParameters(ParameterSnapshot &snapshot) const {
+    snapshot.envelope = EnvelopeCoefficients::fromSettings(snapshot.settings.envelope, sampleRate);
+}
+
+void Synth::setTuning(const Tuning &tuning) {
+    std::unique_ptr<NoteTable> table = std::make_unique<NoteTable>();
+    table->tuning = tuning;
+    tuneNoteTable(*table);
+    noteTables.publish(std::move(table));
+}
+
+Tuning Synth::getTuning() const {
+    return noteTables.read().tuning;
+}
+
+void Synth::tuneNoteTable(NoteTable &table) const {
+    // The wavetables are rate independent: a voice's mip level follows from its increment, so retuning is enough
+    for (int note = 0; note < NUM_NOTES; note++) {
+        table.frequencies[note] = table.tuning.getFrequency(note);
+        table.increments[note] = frequencyToIncrement(table.frequencies[note], sampleRate);
+    }
+    StringBank::tune(sampleRate, table.frequencies, table.strings);
+}
+
+void Synth::acquireSnapshots() {
+    parameters = parameterSnapshots.acquire();
+    const NoteTable *table = noteTables.acquire();
+    if (table != noteTable) {
+        noteTable = table;
+        strings.retune(table->strings);
+    }
+}
+
+void Synth::setWaveform(Waveform waveform) {
+    parameterSnapshots.update([waveform](ParameterSnapshot &snapshot) { snapshot.settings.waveform = waveform; });
+}
+
+Waveform Synth::getWaveform() const {
+    return getParameters().waveform;
+}
+
+const RenderKernel &Synth::getRenderKernel() const {
+    return kernel;
+}
+
+void Synth::setVoiceModel(VoiceModel model) {
+    parameterSnapshots.update([model](ParameterSnapshot &snapshot) { snapshot.settings.voiceModel = model; });
+}
+
+VoiceModel Synth::getVoiceModel() const {
+    return getParameters().voiceModel;
+}
+
+void Synth::setRenderThreads(int threads, const RealtimeOptions &options) {
+    workers.reset();
+    if (threads > 0) {
+        workers = std::make_unique<VoiceWorkerPool>(threads, options);
+    }
+}
+
+int Synth::getRenderThreads() const {
+    return workers ? workers->getWorkerCount() : 0;
+}
+
+ThreadPlacement Synth::getRenderThreadPlacement(int thread) const {
+    return workers ? workers->getPlacement(thread) : ThreadPlacement();
+}
+
+void Synth::prefault() {
+    // One read per 4 KiB reaches every page on every platform the synth builds for
+    constexpr size_t PAGE_FLOATS = 1024;
+    volatile float sink = 0.0f;
+    for (int waveform = 0; waveform < (int)Waveform::COUNT; waveform++) {
+        for (int level = 0; level < WavetableBank::NUM_LEVELS; level++) {
+            const float *table = bank.getTable((Waveform)waveform, level);
+            for (size_t i = 0; i <= WAVETABLE_SIZE; i += PAGE_FLOATS) {
+                sink = sink + table[i];
+            }
+        }
+    }
+    // Every cutoff band's filter
+    for (int band = 0; band < PolyphaseResampler::BANDS; band++) {
+        const float *filter = resampler.filterFor(PolyphaseResampler::bandLimit(band));
+        for (size_t i = 0; i < (PolyphaseResampler::PHASES + 1) * PolyphaseResampler::TAPS; i += PAGE_FLOATS) {
+            sink = sink + filter[i];
+        }
+    }
+
+    float silence[2 * MAX_BLOCK_FRAMES];
+    for (int block = 0; block < 4; block++) {
+        renderFrames(silence, MAX_BLOCK_FRAMES);
+    }
+}
+
+void Synth::setSamplePack(const SamplePack *pack) {
+    streamer.reset();
+    samplePack = pack;
+    if (pack == nullptr) {
+        return;
+    }
+
+    streamer = std::make_unique<SampleStreamer>(*pack);
+    updateRateTables();
+}
+
+uint64_t Synth::getStreamUnderruns() const {
+    return streamer ? streamer->getUnderruns() : 0;
+}
+
+void Synth::setReverb(const std::vector<float> &impulseResponse, double sampleRate) {
+    reverbResponse.clear();
+    if (sampleRate > 0.0) {
+        reverbResponse = impulseResponse;
+        reverbResponseRate = sampleRate;
+    }
+    buildReverb();
+}
+
+void Synth::buildReverb() {
+    reverb.reset();
+    if (reverbResponse.empty()) {
+        return;
+    }
+
+    // Linear interpolation is plenty here; the response is mostly noise and nothing in it is played back as pitch
+    std::vector<float> resampled;
+    const std::vector<float> *response = &reverbResponse;
+    if (reverbResponseRate != sampleRate) {
+        double step = reverbResponseRate / sampleRate;
+        size_t frames = (size_t)((reverbResponse.size() - 1) / step) + 1;
+        resampled.resize(frames);
+        for (size_t i = 0; i < frames; i++) {
+            double position = i * step;
+            size_t index = (size_t)position;
+            float fraction = (float)(position - index);
+            float next = index + 1 < reverbResponse.size() ? reverbResponse[index + 1] : 0.0f;
+            resampled[i] = reverbResponse[index] + fraction * (next - reverbResponse[index]);
+        }
+        response = &resampled;
+    }
+
+    double energy = 0.0;
+    for (float tap : *response) {
+        energy += (double)tap * tap;
+    }
+    if (energy <= 0.0) {
+        return;
+    }
+    std::vector<float> normalized(*response);
+    float scale = (float)(1.0 / sqrt(energy));
+    for (float &tap : normalized) {
+        tap *= scale;
+    }
+    reverb = std::make_unique<PartitionedConvolver>(normalized);
+}
+
+bool Synth::hasReverb() const {
+    return reverb != nullptr;
+}
+
+void Synth::setReverbMix(float mix) {
+    parameterSnapshots.update([mix](ParameterSnapshot &snapshot) { snapshot.settings.reverbMix = mix; });
+}
+
+float Synth::getReverbMix() const {
+    return getParameters().reverbMix;
+}
+
+std::vector<float> Synth::roomImpulseResponse(double seconds, double sampleRate) {
+    std::vector<float> response((size_t)(seconds * sampleRate));
+    // -60 dB over the decay time, with a one-pole lowpass closing as the tail fades like air and walls absorbing highs
+    double decay = log(0.001) / (seconds * sampleRate);
+    uint32_t noise = 22222;
+    float smoothed = 0.0f;
+    for (size_t i = 0; i < response.size(); i++) {
+        noise = noise * 1664525u + 1013904223u;
+        float white = (float)(int32_t)noise * (1.0f / 2147483648.0f);
+        float brightness = 0.9f * (float)exp(-3.0 * i / response.size()) + 0.05f;
+        smoothed += brightness * (white - smoothed);
+        response[i] = smoothed * (float)exp(decay * i);
+    }
+    return response;
+}
+
+void Synth::setSequence(const Sequence *sequence) {
+    this->sequence = sequence;
+    sequenceRunning = false;
+    sequencePlaying.store(false, std::memory_order_relaxed);
+    compileSequence();
+}
+
+void Synth::compileSequence() {
+    sequenceFrames.clear();
+    if (sequence == nullptr) {
+        return;
+    }
+    for (const Sequence::Event &event : sequence->getEvents()) {
+        sequenceFrames.push_back((uint64_t)(event.time * sampleRate + 0.5));
+    }
+}
+
+bool Synth::startSequence(double time) {
+    return events.push(NoteEvent{NoteEvent::SequenceStart, -1, 0, time});
+}
+
+bool Synth::stopSequence(double time) {
+    return events.push(NoteEvent{NoteEvent::SequenceStop, -1, 0, time});
+}
+
+bool Synth::isSequencePlaying() const {
+    return sequencePlaying.load(std::memory_order_relaxed);
+}
+
+bool Synth::isSequenceNoteDown(int note) const {
+    if (note < 0 || note >= NUM_NOTES) {
+        return false;
+    }
+    return (sequenceNotes[note / 64].load(std::memory_order_relaxed) >> (note % 64)) & 1;
+}
+
+void Synth::setNotePan(int note, float pan) {
+    if (note < 0 || note >= NUM_NOTES) {
+        return;
+    }
+    notePans[note].store(pan, std::memory_order_relaxed);
+    panVersion.fetch_add(1, std::memory_order_release);
+}
+
+float Synth::getNotePan(int note) const {
+    return note >= 0 && note < NUM_NOTES ? notePans[note].load(std::memory_order_relaxed) : 0.0f;
+}
+
+void Synth::setStereoWidth(float width) {
+    stereoWidth.store(width, std::memory_order_relaxed);
+    panVersion.fetch_add(1, std::memory_order_release);
+}
+
+float Synth::getStereoWidth() const {
+    return stereoWidth.load(std::memory_order_relaxed);
+}
+
+double Synth::getLimiterLatency() const {
+    return limiter.getLatency() / sampleRate;
+}
+
+bool Synth::noteOn(int note, double time, int velocity) {
+    return events.push(NoteEvent{NoteEvent::NoteOn, note, velocity, time});
+}
+
+bool Synth::noteOff(int note, double time) {
+    return events.push(NoteEvent{NoteEvent::NoteOff, note, 0, time});
+}
+
+bool Synth::allNotesOff(double time) {
+    return events.push(NoteEvent{NoteEvent::AllNotesOff, -1, 0, time});
+}
+
+bool Synth::setSustain(bool down, double time) {
+    return events.push(NoteEvent{down ? NoteEvent::SustainOn : NoteEvent::SustainOff, -1, 0, time});
+}
+
+void Synth::processEvent(const NoteEvent &event, NoteSource source) {
+    Voice **keyVoices = noteVoices[(int)source];
+    bool *keyStrings = stringHeld[(int)source];
+    switch (event.type) {
+        case NoteEvent::NoteOn: {
+            // Keys the tuning leaves unmapped make no sound
+            if (event.note < 0 || event.note >= NUM_NOTES || noteTable->frequencies[event.note] <= 0.0) {
+                return;
+            }
+            // Ignore repeated note-ons so callers can hold a note from a per-frame check
+            if (keyStrings[event.note]) {
+                return;
+            }
+            if (Voice *playing = voiceForNote(event.note, source)) {
+                if (!playing->sustained) {
+                    return;
+                }
+                // Striking a key the pedal is holding plays it again; the old note releases under the new one
+                releaseVoice(*playing);
+            }
+            keyVoices[event.note] = nullptr;
+
+            if (parameters->settings.voiceModel == VoiceModel::Waveguide && StringBank::hasString(event.note)) {
+                strings.setDamper(event.note, false);
+                strings.strike(event.note, event.velocity);
+                keyStrings[event.note] = true;
+                return;
+            }
+
+            Voice *voice = allocateVoice();
+            voice->note = event.note;
+            voice->source = source;
+            voice->sustained = false;
+            voice->zone = samplePack != nullptr ? samplePack->findZone(event.note, event.velocity) : nullptr;
+            if (voice->zone != nullptr) {
+                const SampleZone &zone = *voice->zone;
+                // Samples no longer than their head never need streaming
+                voice->stream = zone.frames > zone.headFrames ? streamer->startStream(&zone) : -1;
+                voice->samplePosition = 0;
+                voice->sampleIncrement = (uint64_t)(noteTable->frequencies[event.note] * zoneIncrementScales[zone.rootNote] + 0.5);
+            } else {
+                voice->phase = 0;
+                voice->increment = noteTable->increments[event.note];
+                voice->table = bank.getTable(parameters->settings.waveform,
+                                             WavetableBank::levelForIncrement(voice->increment));
+            }
+            voice->envelope.noteOn();
+            // A new note starts where it belongs instead of gliding from wherever the voice's last note was
+            updatePans();
+            voice->pan = notePanGains[event.note];
+            keyVoices[event.note] = voice;
+            break;
+        }
+        case NoteEvent::NoteOff: {
+            if (event.note < 0 || event.note >= NUM_NOTES) {
+                return;
+            }
+            if (keyStrings[event.note]) {
+                keyStrings[event.note] = false;
+                // The damper stays up while the pedal or the other source's key holds it
+                if (!sustainDown && !isStringHeld(event.note)) {
+                    strings.setDamper(event.note, true);
+                }
+                return;
+            }
+            Voice *voice = voiceForNote(event.note, source);
+            if (voice == nullptr || voice->sustained) {
+                return;
+            }
+            if (sustainDown) {
+                // Released as far as stealing is concerned, but it keeps sounding until the pedal comes up
+                voice->sustained = true;
+                voice->releaseOrder = ++releaseCount;
+            } else {
+                releaseVoice(*voice);
+                keyVoices[event.note] = nullptr;
+            }
+            break;
+        }
+        case NoteEvent::AllNotesOff: {
+            for (Voice &voice : voices) {
+                releaseVoice(voice);
+            }
+            for (int note = 0; note < NUM_NOTES; note++) {
+                if (StringBank::hasString(note)) {
+                    strings.setDamper(note, true);
+                }
+                for (int owner = 0; owner < (int)NoteSource::COUNT; owner++) {
+                    noteVoices[owner][note] = nullptr;
+                    stringHeld[owner][note] = false;
+                }
+            }
+            break;
+        }
+        case NoteEvent::SustainOn: {
+            sustainDown = true;
+            // The pedal lifts every damper, which lets the whole soundboard ring along
+            for (int note = StringBank::LOWEST_NOTE; note < StringBank::LOWEST_NOTE + StringBank::STRING_COUNT; note++) {
+                strings.setDamper(note, false);
+            }
+            break;
+        }
+        case NoteEvent::SequenceStart: {
+            releaseSequenceNotes();
+            sequenceCursor = 0;
+            sequencePosition = 0;
+            sequenceRunning = sequence != nullptr;
+            sequencePlaying.store(sequenceRunning, std::memory_order_relaxed);
+            break;
+        }
+        case NoteEvent::SequenceStop: {
+            releaseSequenceNotes();
+            sequenceRunning = false;
+            sequencePlaying.store(false, std::memory_order_relaxed);
+            break;
+        }
+        case NoteEvent::SustainOff: {
+            sustainDown = false;
+            for (Voice &voice : voices) {
+                if (voice.note != -1 && voice.sustained) {
+                    if (noteVoices[(int)voice.source][voice.note] == &voice) {
+                        noteVoices[(int)voice.source][voice.note] = nullptr;
+                    }
+                    releaseVoice(voice);
+                }
+            }
+            for (int note = StringBank::LOWEST_NOTE; note < StringBank::LOWEST_NOTE + StringBank::STRING_COUNT; note++) {
+                if (!isStringHeld(note)) {
+                    strings.setDamper(note, true);
+                }
+            }
+            break;
+        }
+    }
+}
+
+unsigned long Synth::advanceSequence(unsigned long limit) {
+    if (!sequenceRunning) {
+        return limit;
+    }
+    const std::vector<Sequence::Event> &songEvents = sequence->getEvents();
+    while (sequenceCursor < songEvents.size() && sequenceFrames[sequenceCursor] <= sequencePosition) {
+        const Sequence::Event &event = songEvents[sequenceCursor++];
+        processEvent(NoteEvent{event.type, event.note, event.velocity, 0.0}, NoteSource::Sequence);
+        if (event.note >= 0 && event.note < NUM_NOTES) {
+            uint64_t bit = 1ull << (event.note % 64);
+            if (event.type == NoteEvent::NoteOn) {
+                sequenceNotes[event.note / 64].fetch_or(bit, std::memory_order_relaxed);
+            } else if (event.type == NoteEvent::NoteOff) {
+                sequenceNotes[event.note / 64].fetch_and(~bit, std::memory_order_relaxed);
+            }
+        }
+    }
+    if (sequenceCursor == songEvents.size()) {
+        sequenceRunning = false;
+        sequencePlaying.store(false, std::memory_order_relaxed);
+        return limit;
+    }
+    uint64_t ahead = sequenceFrames[sequenceCursor] - sequencePosition;
+    return ahead < limit ? (unsigned long)ahead : limit;
+}
+
+void Synth::releaseSequenceNotes() {
+    for (int note = 0; note < NUM_NOTES; note++) {
+        if (isSequenceNoteDown(note)) {
+            processEvent(NoteEvent{NoteEvent::NoteOff, note, 0, 0.0}, NoteSource::Sequence);
+        }
+    }
+    for (std::atomic<uint64_t> &notes : sequenceNotes) {
+        notes.store(0, std::memory_order_relaxed);
+    }
+}
+
+Voice *Synth::voiceForNote(int note, NoteSource source) const {
+    // Entries go stale when a voice finishes on its own; a freed or reused voice no longer matches the note
+    Voice *voice = noteVoices[(int)source][note];
+    return voice != nullptr && voice->note == note && voice->source == source && voice->isHeld() ? voice : nullptr;
+}
+
+bool Synth::isStringHeld(int note) const {
+    for (int source = 0; source < (int)NoteSource::COUNT; source++) {
+        if (stringHeld[source][note]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Synth::releaseVoice(Voice &voice) {
+    if (voice.note == -1) {
+        return;
+    }
+    voice.envelope.noteOff();
+    voice.sustained = false;
+    voice.releaseOrder = ++releaseCount;
+}
+
+Voice *Synth::allocateVoice() {
+    // One pass finds a free voice or, failing that, the voice to steal:
+    // the oldest one whose key is up, or the quietest if every key is still down
+    Voice *oldestReleased = nullptr;
+    Voice *quietest = nullptr;
+    for (Voice &voice : voices) {
+        if (voice.note == -1) {
+            return &voice;
+        }
+        if (!voice.isHeld() || voice.sustained) {
+            if (oldestReleased == nullptr || voice.releaseOrder < oldestReleased->releaseOrder) {
+                oldestReleased = &voice;
+            }
+        } else if (quietest == nullptr || voice.envelope.getLevel() < quietest->envelope.getLevel()) {
+            quietest = &voice;
+        }
+    }
+    Voice *victim = oldestReleased != nullptr ? oldestReleased : quietest;
+    stealVoice(*victim);
+    return victim;
+}
+
+void Synth::stealVoice(Voice &victim) {
+    // The victim's sound moves to a fading slot so the voice can start its new note at once without a click
+    Voice *fade = nullptr;
+    for (Voice &voice : fadingVoices) {
+        if (voice.note == -1) {
+            fade = &voice;
+            break;
+        }
+        if (fade == nullptr || voice.envelope.getLevel() < fade->envelope.getLevel()) {
+            fade = &voice;
+        }
+    }
+    // Every slot busy means a burst of steals inside one fade time; cut the quietest fade short
+    if (fade->note != -1 && fade->stream >= 0) {
+        streamer->stopStream(fade->stream);
+    }
+
+    *fade = victim;
+    fade->envelope.fadeOut();
+    if (noteVoices[(int)victim.source][victim.note] == &victim) {
+        noteVoices[(int)victim.source][victim.note] = nullptr;
+    }
+    victim.stream = -1;
+    victim.envelope.reset();
+}
+
+void Synth::render(float *out, unsigned long framesPerBuffer, double bufferTime) {
+    // Parameters change between buffers, never within one
+    acquireSnapshots();
+    unsigned long frame = 0;
+    while (frame < framesPerBuffer) {
+        // Apply every event due by this frame, then render up to the next one
+        unsigned long nextEvent = framesPerBuffer;
+        while (const NoteEvent *event = events.peek()) {
+            unsigned long offset = eventOffset(*event, bufferTime, framesPerBuffer);
+            if (offset > frame) {
+                nextEvent = offset < framesPerBuffer ? offset : framesPerBuffer;
+                break;
+            }
+            processEvent(*event);
+            NoteEvent done;
+            events.pop(done);
+        }
+
+        // Then the song's events due by this frame; its next one also ends the run
+        unsigned long songEvent = frame + advanceSequence(nextEvent - frame);
+        nextEvent = songEvent < nextEvent ? songEvent : nextEvent;
+
+        renderFrames(out + frame * 2, nextEvent - frame);
+        if (sequenceRunning) {
+            sequencePosition += nextEvent - frame;
+        }
+        frame = nextEvent;
+    }
+}
+
+unsigned long Synth::eventOffset(const NoteEvent &event, double bufferTime, unsigned long framesPerBuffer) const {
+    if (event.time <= 0.0 || bufferTime <= 0.0) {
+        return 0;
+    }
+    double offset = (event.time - bufferTime) * sampleRate;
+    if (offset <= 0.0) {
+        return 0;
+    }
+    // An event more than a second ahead means the clocks disagree; play it now instead of holding up the queue
+    if (offset > sampleRate) {
+        return 0;
+    }
+    return offset < (double)framesPerBuffer ? (unsigned long)offset : framesPerBuffer;
+}
+
+void Synth::renderFrames(float *out, unsigned long frames) {
+    while (frames > 0) {
+        unsigned long block = frames < MAX_BLOCK_FRAMES ? frames : MAX_BLOCK_FRAMES;
+        renderBlock(out, block);
+        out += block * 2;
+        frames -= block;
+    }
+}
+
+void Synth::renderBlock(float *out, unsigned long framesPerBlock) {
+    for (unsigned long i = 0; i < 2 * framesPerBlock; i++) {
+        mix[i] = 0.0f;
+    }
+    updatePans();
+    // A glide across the whole field moves a gain by √2
+    panStep = (float)(M_SQRT2 * framesPerBlock / (PAN_GLIDE_SECONDS * sampleRate));
+
+    activeVoiceCount = 0;
+    for (Voice &voice : voices) {
+        if (voice.note != -1) {
+            activeVoices[activeVoiceCount++] = &voice;
+        }
+    }
+    for (Voice &voice : fadingVoices) {
+        if (voice.note != -1) {
+            activeVoices[activeVoiceCount++] = &voice;
+        }
+    }
+
+    if (workers && activeVoiceCount >= PARALLEL_MIN_VOICES) {
+        // Neighbouring voices go in the same group so groups rarely share cache lines
+        int groups = (activeVoiceCount + VOICES_PER_GROUP - 1) / VOICES_PER_GROUP;
+        workers->render(&Synth::renderVoiceGroup, this, groups, mix, scratch, framesPerBlock);
+    } else {
+        for (int i = 0; i < activeVoiceCount; i++) {
+            renderVoice(*activeVoices[i], mix, scratch, framesPerBlock);
+        }
+    }
+
+    float *left = mix;
+    float *right = mix + framesPerBlock;
+
+    // The strings share one soundboard, which sits in the middle
+    for (unsigned long i = 0; i < framesPerBlock; i++) {
+        wet[i] = 0.0f;
+    }
+    strings.render(wet, framesPerBlock);
+    for (unsigned long i = 0; i < framesPerBlock; i++) {
+        left[i] += wet[i];
+        right[i] += wet[i];
+    }
+
+    // The room hears the mono sum and answers from everywhere
+    if (reverb) {
+        for (unsigned long i = 0; i < framesPerBlock; i++) {
+            wet[i] = 0.5f * (left[i] + right[i]);
+        }
+        reverb->process(wet, wet, framesPerBlock);
+        float amount = parameters->settings.reverbMix;
+        for (unsigned long i = 0; i < framesPerBlock; i++) {
+            left[i] += amount * wet[i];
+            right[i] += amount * wet[i];
+        }
+    }
+
+    // A new volume glides in across the block instead of stepping
+    float volume = parameters->settings.volume;
+    if (volume != DEFAULT_VOLUME || appliedVolume != DEFAULT_VOLUME) {
+        float step = (volume - appliedVolume) / framesPerBlock;
+        for (unsigned long i = 0; i < framesPerBlock; i++) {
+            float gain = appliedVolume + step * (i + 1);
+            left[i] *= gain;
+            right[i] *= gain;
+        }
+        appliedVolume = volume;
+    }
+
+    limiter.process(left, right, out, framesPerBlock);
+}
+
+void Synth::updatePans() {
+    uint32_t version = panVersion.load(std::memory_order_acquire);
+    if (version == appliedPanVersion) {
+        return;
+    }
+    appliedPanVersion = version;
+    float width = stereoWidth.load(std::memory_order_relaxed);
+    for (int note = 0; note < NUM_NOTES; note++) {
+        notePanGains[note] = constantPowerPan(width * notePans[note].load(std::memory_order_relaxed));
+    }
+}
+
+void Synth::renderVoice(Voice &voice, float *mix, float *scratch, unsigned long frames) const {
+    float *gain = scratch;
+    float *out = scratch + MAX_BLOCK_FRAMES;
+    for (unsigned long i = 0; i < frames; i++) {
+        out[i] = 0.0f;
+    }
+    if (voice.zone != nullptr) {
+        renderSampleVoice(voice, out, gain, frames);
+    } else {
+        voice.envelope.render(parameters->envelope, VOICE_GAIN, gain, frames);
+        kernel.renderVoice(voice.table, voice.phase, voice.increment, gain, out, frames);
+    }
+
+    // Glide towards the note's pan, no faster than panStep per block
+    const PanGains &target = notePanGains[voice.note];
+    PanGains to;
+    float moveLeft = target.left - voice.pan.left;
+    float moveRight = target.right - voice.pan.right;
+    to.left = voice.pan.left + (moveLeft > panStep ? panStep : (moveLeft < -panStep ? -panStep : moveLeft));
+    to.right = voice.pan.right + (moveRight > panStep ? panStep : (moveRight < -panStep ? -panStep : moveRight));
+    addPanned(out, mix, mix + frames, frames, voice.pan, to);
+    voice.pan = to;
+
+    if (!voice.envelope.isActive()) {
+        voice.note = -1;
+        if (voice.stream >= 0) {
+            streamer->stopStream(voice.stream);
+            voice.stream = -1;
+        }
+    }
+}
+
+void Synth::renderSampleVoice(Voice &voice, float *out, float *gain, unsigned long frames) const {
+    const SampleZone &zone = *voice.zone;
+    voice.envelope.render(sampleEnvelope, VOICE_GAIN, gain, frames);
+
+    // Read the stream's progress once per block; it only ever grows
+    uint64_t loaded = zone.headFrames + (voice.stream >= 0 ? streamer->available(voice.stream) : 0);
+
+    // A zone played at its root on an output at the pack's rate is copied frame for frame; anything else is resampled
+    const bool direct = voice.sampleIncrement == (1ull << 32);
+    const float *filter = resampler.filterFor(voice.sampleIncrement);
+    const uint64_t lookahead = direct ? 0 : PolyphaseResampler::TAPS - PolyphaseResampler::HISTORY - 1;
+    float scratch[PolyphaseResampler::TAPS];
+
+    for (unsigned long i = 0; i < frames; i++) {
+        uint64_t frame = voice.samplePosition >> 32;
+        if (frame + 1 >= zone.frames) {
+            voice.envelope.reset();
+            break;
+        }
+        uint64_t needed = frame + lookahead < zone.frames ? frame + lookahead : zone.frames - 1;
+        if (needed >= loaded) {
+            if (voice.stream < 0) {
+                // No stream was free when the note started, so the head is all there is
+                voice.envelope.reset();
+            } else {
+                // Keep time through the gap so the note picks up where it should once the streamer catches up
+                streamer->recordUnderrun();
+                voice.samplePosition += voice.sampleIncrement * (frames - i);
+            }
+            break;
+        }
+        float value = direct ? sampleFrame(voice, frame)
+                             : PolyphaseResampler::interpolate(filter, resamplerFrames(voice, frame, scratch),
+                                                               (uint32_t)voice.samplePosition);
+        out[i] += gain[i] * value;
+        voice.samplePosition += voice.sampleIncrement;
+    }
+
+    if (voice.stream >= 0) {
+        // The resampler reads a few frames behind the position, which must stay in the ring
+        uint64_t frame = voice.samplePosition >> 32;
+        uint64_t oldest = frame > (uint64_t)PolyphaseResampler::HISTORY ? frame - PolyphaseResampler::HISTORY : 0;
+        streamer->consume(voice.stream, oldest > zone.headFrames ? oldest - zone.headFrames : 0);
+    }
+}
+
+float Synth::sampleFrame(const Voice &voice, uint64_t frame) const {
+    const SampleZone &zone = *voice.zone;
+    return frame < zone.headFrames ? zone.head[frame] : streamer->sampleAt(voice.stream, frame - zone.headFrames);
+}
+
+const float *Synth::resamplerFrames(const Voice &voice, uint64_t frame, float *scratch) const {
+    const SampleZone &zone = *voice.zone;
+    const uint64_t first = frame - PolyphaseResampler::HISTORY;
+    const uint64_t end = first + PolyphaseResampler::TAPS;
+
+    // Nearly always the frames lie together in the head or the ring already
+    if (frame >= (uint64_t)PolyphaseResampler::HISTORY && end <= zone.frames) {
+        if (end <= zone.headFrames) {
+            return zone.head + first;
+        }
+        if (first >= zone.headFrames && voice.stream >= 0) {
+            const float *frames = streamer->framesAt(voice.stream, first - zone.headFrames, PolyphaseResampler::TAPS);
+            if (frames != nullptr) {
+                return frames;
+            }
+        }
+    }
+
+    for (int tap = 0; tap < PolyphaseResampler::TAPS; tap++) {
+        uint64_t source = first + tap;
+        // Before the start the unsigned position wraps to a huge value, which the end check also catches
+        scratch[tap] = source < zone.frames ? sampleFrame(voice, source) : 0.0f;
+    }
+    return scratch;
+}
+
+void Synth::renderVoiceGroup(void *context, int group, float *mix, float *scratch, unsigned long frames) {
+    Synth *synth = static_cast<Synth *>(context);
+    int first = group * VOICES_PER_GROUP;
+    int last = first + VOICES_PER_GROUP < synth->activeVoiceCount ? first + VOICES_PER_GROUP : synth->activeVoiceCount;
+    for (int i = first; i < last; i++) {
+        synth->renderVoice(*synth->activeVoices[i], mix, scratch, frames);
+    }
+}
+
+int Synth::getActiveVoiceCount() const {
+    int count = 0;
+    for (const Voice &voice : voices) {
+        if (voice.note != -1) {
+            count++;
+        }
+    }
+    for (const Voice &voice : fadingVoices) {
+        if (voice.note != -1) {
+            count++;
+        }
+    }
+    return count;
+}
+
+double Synth::noteToFrequency(int note) {
+    return 440.0 * pow(2.0, (note - 69) / 12.0);
+}
+
+uint32_t Synth::frequencyToIncrement(double frequency, double sampleRate) {
+    // 2^32 phase units per cycle
+    return (uint32_t)(frequency / sampleRate * 4294967296.0 + 0.5);
+}
@@ -0,0 +1,552 @@
+#ifndef GRAPHICS_SYNTH_H
+#define GRAPHICS_SYNTH_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "convolver.h"
+#include "envelope.h"
+#include "mixer.h"
+#include "noteEvent.h"
+#include "polyphaseResampler.h"
+#include "renderKernel.h"
+#include "sequence.h"
+#include "samplePack.h"
+#include "sampleStreamer.h"
+#include "snapshotStore.h"
+#include "spscQueue.h"
+#include "stringBank.h"
+#include "tuning.h"
+#include "voice.h"
+#include "voiceWorkerPool.h"
+#include "wavetable.h"
+
+/// @brief How the synth makes the notes it does not play from a sample pack.
+enum class VoiceModel {
+    Wavetable, // one band-limited wavetable voice per note
+    Waveguide  // the StringBank's physically modelled piano strings
+};
+
+/**
+ * @brief A polyphonic wavetable synthesizer.
+ * @details The synth owns a fixed pool of voices that are mixed together by render().
+ * render() is meant to be called from an always-running audio callback, so starting and
+ * stopping a note only changes voice state instead of starting or stopping a stream.
+ *
+ * noteOn(), noteOff() and allNotesOff() may be called from one input thread. They push
+ * timestamped events onto a lock-free queue that render() drains, so the voice pool is only
+ * ever touched by the audio thread (and, during a dense block, by the render workers it hands voices to). Each event is applied at the sample its timestamp maps to
+ * inside the buffer, so note timing does not depend on when the buffer happened to be rendered.
+ *
+ * Voices are mixed onto a stereo bus, each panned by where its key sits, and the bus ends in a look-ahead
+ * limiter, so dense chords stay under full scale without every voice being turned down to make room.
+ *
+ * The synth renders at whatever rate the output device runs at natively, so neither the host nor the OS has to
+ * resample behind it. Sample packs recorded at another rate are read through a polyphase resampler.
+ *
+ * Settings a UI changes while the synth plays (volume, envelope, timbre and tuning) reach the audio callback as
+ * immutable snapshots in a SnapshotStore: the setter builds a new snapshot on its own thread and publishes it with one
+ * pointer swap, render() picks it up at the start of its next buffer, and the old one is freed back on a setter's
+ * thread. The callback never waits on a lock and never sees half of a change.
+ */
+class Synth {
+public:
+    /// @brief The number of voices that can sound at the same time.
+    static constexpr int MAX_VOICES = 256;
+
+    /// @brief The number of stolen voices that can be fading out at the same time, on top of MAX_VOICES.
+    static constexpr int FADE_VOICES = 16;
+
+    /// @brief The largest block rendered in one pass. Longer buffers are rendered in several blocks.
+    static constexpr unsigned long MAX_BLOCK_FRAMES = 256;
+
+    /// @brief The sample rate new synths render at, until setSampleRate() is called.
+    static constexpr double DEFAULT_SAMPLE_RATE = 44100.0;
+
+    /// @brief Blocks with fewer active voices than this are rendered on the audio thread alone.
+    /// @details Below this, handing voices to the workers costs more than rendering them.
+    static constexpr int PARALLEL_MIN_VOICES = 16;
+
+    /// @brief The number of voices in each group handed to a render worker.
+    static constexpr int VOICES_PER_GROUP = 4;
+
+    /// @brief The number of MIDI notes.
+    static constexpr int NUM_NOTES = 128;
+
+    /// @brief The envelope every voice uses.
+    static constexpr EnvelopeSettings DEFAULT_ENVELOPE = {0.005f, 0.8f, 0.4f, 0.25f};
+
+    /// @brief The envelope sampled voices use. Recordings carry their own decay, so it only smooths the start and the release.
+    static constexpr EnvelopeSettings SAMPLE_ENVELOPE = {0.001f, 0.0f, 1.0f, 0.25f};
+
+    /// @brief How far new synths spread the keyboard across the stereo field, from 0 (mono) to 1 (hard left to hard right).
+    static constexpr float DEFAULT_STEREO_WIDTH = 0.6f;
+
+    /// @brief How long a voice takes to glide across the whole stereo field when its pan changes.
+    static constexpr double PAN_GLIDE_SECONDS = 0.05;
+
+    /// @brief The velocity of notes started without one.
+    static constexpr int DEFAULT_VELOCITY = 100;
+
+    /// @brief Construct a new Synth object
+    /// @details Uses the shared wavetable bank and picks the fastest render kernel for this CPU. All voices start out free.
+    Synth();
+
+    /// @brief Construct a new Synth object that renders with a specific kernel.
+    /// @param kernel The kernel used to render voices
+    explicit Synth(const RenderKernel &kernel);
+
+    /// @brief Construct a new Synth object that reads from a specific wavetable bank.
+    /// @param bank The wavetables voices play. Must outlive the synth.
+    /// @param kernel The kernel used to render voices
+    Synth(const WavetableBank &bank, const RenderKernel &kernel);
+
+    /// @brief Sets the rate the synth renders at, usually the output device's native rate.
+    /// @details Retunes every note, the envelopes, the strings, the sample pack's playback speeds and the reverb.
+    /// Silences whatever the strings were playing and rebuilds the reverb, so call it before the audio backend
+    /// starts, never while render() runs.
+    void setSampleRate(double sampleRate);
+
+    /// @brief The rate the synth renders at.
+    double getSampleRate() const;
+
+    /// @brief The master volume new synths start with.
+    static constexpr float DEFAULT_VOLUME = 1.0f;
+
+    /// @brief The reverb mix new synths start with.
+    static constexpr float DEFAULT_REVERB_MIX = 0.3f;
+
+    /// @brief Everything a UI may change while the synth plays, published to render() together.
+    struct Parameters {
+        /// @brief The gain applied to the mix ahead of the limiter. Changes glide across one block.
+        float volume = DEFAULT_VOLUME;
+
+        /// @brief The envelope of wavetable voices, playing ones included.
+        EnvelopeSettings envelope = DEFAULT_ENVELOPE;
+
+        /// @brief The waveform of notes started from now on.
+        Waveform waveform = Waveform::Piano;
+
+        /// @brief How notes started from now on are made.
+        VoiceModel voiceModel = VoiceModel::Wavetable;
+
+        /// @brief How much of the convolved signal is added to the dry mix.
+        float reverbMix = DEFAULT_REVERB_MIX;
+    };
+
+    /// @brief Replaces every parameter at once. Safe to call from any thread but the audio thread, while render() runs.
+    /// @details The new values are worked out here and published as one snapshot, which render() picks up at the
+    /// start of its next buffer, so it never sees some of them changed and not others.
+    void setParameters(const Parameters &parameters);
+
+    /// @brief The parameters last set.
+    Parameters getParameters() const;
+
+    /// @brief Frees parameter snapshots and note tables render() has moved past since they were replaced.
+    /// @details Setters already free what they can; calling this now and then from a control thread, such as the
+    /// UI's frame loop, frees the one render() was still using at the time. Never call it from the audio thread.
+    void reclaimSnapshots();
+
+    /// @brief Sets the master volume. Safe to call while render() runs, like setParameters().
+    /// @param volume 0 for silence, 1 for unity gain
+    void setVolume(float volume);
+
+    /// @brief The master volume.
+    float getVolume() const;
+
+    /// @brief Sets the envelope of wavetable voices. Safe to call while render() runs, like setParameters().
+    void setEnvelope(const EnvelopeSettings &envelope);
+
+    /// @brief The envelope of wavetable voices.
+    EnvelopeSettings getEnvelope() const;
+
+    /// @brief Retunes the keyboard. Safe to call while render() runs, like setParameters().
+    /// @details Builds the new note table here, so the audio thread only swaps a pointer. Wavetable and sampled notes
+    /// start at their new pitch; notes already playing keep theirs. The piano strings retune at once, ringing or not.
+    /// Keys the tuning leaves unmapped are silent.
+    void setTuning(const Tuning &tuning);
+
+    /// @brief The keyboard's tuning.
+    Tuning getTuning() const;
+
+    /// @brief Sets the waveform used by notes started from now on. Safe to call while render() runs.
+    void setWaveform(Waveform waveform);
+
+    /// @brief The waveform used by new notes.
+    Waveform getWaveform() const;
+
+    /// @brief The kernel used to render voices.
+    const RenderKernel &getRenderKernel() const;
+
+    /// @brief Sets how notes started from now on are made. Notes already playing finish as they started.
+    /// Safe to call while render() runs.
+    /// @details With the waveguide model, notes outside the piano's range still play the wavetable.
+    void setVoiceModel(VoiceModel model);
+
+    /// @brief How new notes are made.
+    VoiceModel getVoiceModel() const;
+
+    /// @brief Sets how many helper threads render voices alongside the audio thread in dense passages.
+    /// @details Starts or stops threads, so call it before the audio backend starts, never while render() runs.
+    /// @param threads The number of helper threads, or 0 to render on the audio thread only
+    /// @param options The priority and cores to run the helpers at, see VoiceWorkerPool
+    void setRenderThreads(int threads, const RealtimeOptions &options = RealtimeOptions());
+
+    /// @brief The number of helper threads rendering voices.
+    int getRenderThreads() const;
+
+    /// @brief How a helper thread was scheduled when it started.
+    /// @param thread From 0 to getRenderThreads() - 1
+    ThreadPlacement getRenderThreadPlacement(int thread) const;
+
+    /// @brief Touches every page the audio path reads, so the first notes do not stall on page faults.
+    /// @details Reads through the wavetables and resampler filters, and renders a few silent blocks through the
+    /// mix, the strings, the reverb and the limiter. Call it once everything is set and before the audio backend
+    /// starts, never while render() runs.
+    void prefault();
+
+    /// @brief Plays notes from recorded samples instead of the wavetables.
+    /// @details Keys the pack has no zone for still play the wavetable. Starts or stops the streaming thread,
+    /// so call it before the audio backend starts, never while render() runs.
+    /// @param pack The pack to play, which must stay open while the synth uses it, or null to use the wavetables only
+    void setSamplePack(const SamplePack *pack);
+
+    /// @brief The number of times a sampled voice ran ahead of the streaming thread and played silence.
+    uint64_t getStreamUnderruns() const;
+
+    /// @brief Convolves the mixed voices with an impulse response, such as a room or a piano's soundboard.
+    /// @details The response is rescaled to unit energy, so a mix of 1 is roughly as loud as the dry signal,
+    /// and resampled to the synth's rate if needed, now and whenever the rate changes. Builds the convolver, so call it
+    /// before the audio backend starts, never while render() runs.
+    /// @param impulseResponse The impulse response, or empty to turn the reverb off
+    /// @param sampleRate The rate the impulse response was recorded at
+    void setReverb(const std::vector<float> &impulseResponse, double sampleRate = DEFAULT_SAMPLE_RATE);
+
+    /// @brief Whether an impulse response is set.
+    bool hasReverb() const;
+
+    /// @brief Sets how much of the convolved signal is added to the dry mix. Safe to call while render() runs.
+    void setReverbMix(float mix);
+
+    /// @brief How much of the convolved signal is added to the dry mix.
+    float getReverbMix() const;
+
+    /// @brief A synthetic room: exponentially decaying noise that darkens as it fades.
+    /// @param seconds How long the response takes to decay by 60 dB
+    /// @param sampleRate The rate to generate the response at
+    static std::vector<float> roomImpulseResponse(double seconds = 2.0, double sampleRate = DEFAULT_SAMPLE_RATE);
+
+    /// @brief Places a note in the stereo field. Safe to call while render() runs; playing notes glide to it.
+    /// @details Notes start out spread evenly from the bottom of the piano on the left to the top on the right.
+    /// @param note The MIDI note
+    /// @param pan -1 for hard left, 0 for the centre, 1 for hard right, before the stereo width is applied
+    void setNotePan(int note, float pan);
+
+    /// @brief Where a note sits in the stereo field, before the stereo width is applied.
+    float getNotePan(int note) const;
+
+    /// @brief Scales every note's pan. Safe to call while render() runs; playing notes glide to it.
+    /// @param width 0 for mono, 1 for the notes' full pans
+    void setStereoWidth(float width);
+
+    /// @brief How far the notes' pans are spread.
+    float getStereoWidth() const;
+
+    /// @brief How long the master limiter delays the output, in seconds.
+    double getLimiterLatency() const;
+
+    /// @brief The number of note events that can be waiting for the audio callback.
+    static constexpr size_t EVENT_QUEUE_SIZE = 256;
+
+    /// @brief Queues a note to start playing on a free voice.
+    /// @details Does nothing if the key is already down. A key the sustain pedal is holding is played again.
+    /// If every voice is busy, the voice whose key was released longest ago is stolen, or the quietest one if every
+    /// key is still down. The stolen note fades out over a few milliseconds instead of being cut off.
+    /// @param note The MIDI note number to play (60 is middle C)
+    /// @param time When the key was pressed, in seconds on the stream's clock
+    /// @param velocity How hard the key was struck, 1 to 127
+    /// @return false if the event queue is full and the event was dropped
+    bool noteOn(int note, double time = 0.0, int velocity = DEFAULT_VELOCITY);
+
+    /// @brief Queues a note to release. Its voice is freed once the release has faded out.
+    /// @details Does nothing if the note is not playing. While the sustain pedal is down, the note keeps sounding
+    /// until the pedal comes up.
+    /// @param note The MIDI note number to stop
+    /// @param time When the key was released, in seconds on the stream's clock
+    /// @return false if the event queue is full and the event was dropped
+    bool noteOff(int note, double time = 0.0);
+
+    /// @brief Queues every playing note to release.
+    /// @return false if the event queue is full and the event was dropped
+    bool allNotesOff(double time = 0.0);
+
+    /// @brief Queues the sustain pedal going down or coming up.
+    /// @details While it is down, released notes keep sounding and every piano string's damper is lifted.
+    /// Bringing it up releases the notes whose keys are up.
+    /// @return false if the event queue is full and the event was dropped
+    bool setSustain(bool down, double time = 0.0);
+
+    /// @brief Sets the song startSequence() plays.
+    /// @details Converts the song's times to sample positions, now and whenever the rate changes, so call it before
+    /// the audio backend starts, never while render() runs.
+    /// @param sequence The song, which must outlive the synth's use of it, or null
+    void setSequence(const Sequence *sequence);
+
+    /// @brief Queues the song to start from the beginning, restarting it if it is already playing.
+    /// @details Its events then play at their exact sample positions from inside render(), however the caller's
+    /// frames are timed.
+    /// @param time When the song starts, in seconds on the stream's clock
+    /// @return false if the event queue is full and the event was dropped
+    bool startSequence(double time = 0.0);
+
+    /// @brief Queues the song to stop. The notes it is holding are released.
+    /// @return false if the event queue is full and the event was dropped
+    bool stopSequence(double time = 0.0);
+
+    /// @brief Whether the song is playing. Safe to call from any thread.
+    bool isSequencePlaying() const;
+
+    /// @brief Whether the song is holding a note's key down. Safe to call from any thread, to show the song's keys.
+    bool isSequenceNoteDown(int note) const;
+
+    /// @brief Mixes every active voice into an interleaved stereo buffer, applying queued note events at their sample offsets.
+    /// @details Called from the audio callback. Never blocks or allocates.
+    /// An event stamped at bufferTime lands on the first frame, one stamped a sample later on the second, and so on.
+    /// Events due after the buffer stay queued for a later one.
+    /// Events stamped 0, or any event when bufferTime is 0, are applied at the first frame.
+    /// @param out The interleaved stereo output buffer
+    /// @param framesPerBuffer The number of frames to render
+    /// @param bufferTime The time on the event clock that the first frame corresponds to, or 0 if there is no clock
+    void render(float *out, unsigned long framesPerBuffer, double bufferTime = 0.0);
+
+    /// @brief The number of voices currently sounding, including ones still releasing.
+    /// @details Reads the voice pool, so only call this from the thread that calls render().
+    int getActiveVoiceCount() const;
+
+    /// @brief Converts a MIDI note number to its frequency in equal temperament (A4 = 440 Hz), whatever the synth's tuning.
+    static double noteToFrequency(int note);
+
+    /// @brief Converts a frequency to a 32-bit fixed-point phase increment at a sample rate.
+    static uint32_t frequencyToIncrement(double frequency, double sampleRate);
+
+private:
+    /// @brief The gain applied to each voice before mixing.
+    static constexpr float VOICE_GAIN = 0.2f;
+
+    /// @brief Applies a single note event to the voice pool. Audio thread only.
+    /// @param source Whose keys the event comes from. Note-offs only release notes the same source started.
+    void processEvent(const NoteEvent &event, NoteSource source = NoteSource::Player);
+
+    /// @brief The voice a source's key is playing on, or null. O(1): reads the note index and checks it is current.
+    Voice *voiceForNote(int note, NoteSource source) const;
+
+    /// @brief Whether the player or the song holds a key's string damper up.
+    bool isStringHeld(int note) const;
+
+    /// @brief Starts a voice's release and records when, for voice stealing.
+    void releaseVoice(Voice &voice);
+
+    /// @brief A free voice, or a stolen one if the pool is full. Never null.
+    Voice *allocateVoice();
+
+    /// @brief Moves a voice's sound to a fading slot and frees the voice for a new note.
+    void stealVoice(Voice &victim);
+
+    /// @brief Converts the song's event times to frames at the synth's rate.
+    void compileSequence();
+
+    /// @brief Plays the song's events due at the current position.
+    /// @return the number of frames until its next event, or limit if there is none that soon
+    unsigned long advanceSequence(unsigned long limit);
+
+    /// @brief Releases every note the song is holding.
+    void releaseSequenceNotes();
+
+    /// @brief Everything about a tuning the audio thread reads, worked out at the synth's rate.
+    struct NoteTable {
+        /// @brief The tuning the table was built from.
+        Tuning tuning;
+
+        /// @brief Each note's frequency in Hz, 0 for keys the tuning leaves unmapped.
+        double frequencies[NUM_NOTES];
+
+        /// @brief Each note's wavetable phase increment, so starting a note needs no transcendental math.
+        uint32_t increments[NUM_NOTES];
+
+        /// @brief The piano strings tuned to the same pitches.
+        StringBank::Tuning strings;
+    };
+
+    /// @brief Recomputes everything that depends on the sample rate, apart from the strings and the reverb.
+    void updateRateTables();
+
+    /// @brief The parameters with everything render() derives from them, worked out at the synth's rate.
+    struct ParameterSnapshot {
+        Parameters settings;
+
+        /// @brief settings.envelope converted to per-sample steps.
+        EnvelopeCoefficients envelope;
+    };
+
+    /// @brief Works out a note table's increments and string tuning from its tuning, at the synth's rate.
+    void tuneNoteTable(NoteTable &table) const;
+
+    /// @brief Works out what a parameter snapshot derives from its settings, at the synth's rate.
+    void deriveParameters(ParameterSnapshot &snapshot) const;
+
+    /// @brief Switches to the newest parameters and note table. Audio thread only, or while render() is not running.
+    void acquireSnapshots();
+
+    /// @brief Builds the reverb from its impulse response at the synth's rate.
+    void buildReverb();
+
+    /// @brief The frame of the current buffer an event is due on. May be at or past framesPerBuffer.
+    unsigned long eventOffset(const NoteEvent &event, double bufferTime, unsigned long framesPerBuffer) const;
+
+    /// @brief Mixes every active voice into the interleaved output, in blocks of at most MAX_BLOCK_FRAMES.
+    void renderFrames(float *out, unsigned long frames);
+
+    /// @brief Mixes every active voice into the interleaved output. framesPerBlock must not exceed MAX_BLOCK_FRAMES.
+    /// @details Splits the voices into groups across the render workers when enough of them are active,
+    /// then adds the strings and the reverb and limits the result.
+    void renderBlock(float *out, unsigned long framesPerBlock);
+
+    /// @brief Recomputes notePanGains if a pan or the width has changed since the last block.
+    void updatePans();
+
+    /// @brief Adds one voice, panned, to a planar stereo mix and frees it once its envelope has finished.
+    /// @param scratch 2 * MAX_BLOCK_FRAMES floats: the envelope's gain, then the voice's mono output
+    void renderVoice(Voice &voice, float *mix, float *scratch, unsigned long frames) const;
+
+    /// @brief Adds a sampled voice to a mono buffer, reading its head and then its stream.
+    /// @details Ends the voice when the sample runs out. If the streamer has fallen behind, the missing frames are silent.
+    void renderSampleVoice(Voice &voice, float *out, float *gain, unsigned long frames) const;
+
+    /// @brief One frame of a sampled voice's sample, from the resident head or the stream.
+    float sampleFrame(const Voice &voice, uint64_t frame) const;
+
+    /// @brief The TAPS frames the resampler reads around a frame, from where they already lie if they are
+    /// contiguous, otherwise copied into scratch. Frames before the start or past the end of the sample read as silence.
+    const float *resamplerFrames(const Voice &voice, uint64_t frame, float *scratch) const;
+
+    /// @brief Renders one group of activeVoices for the worker pool. context is the Synth.
+    static void renderVoiceGroup(void *context, int group, float *mix, float *scratch, unsigned long frames);
+
+    /// @brief Note events waiting for the audio callback.
+    SpscQueue<NoteEvent, EVENT_QUEUE_SIZE> events;
+
+    /// @brief The preallocated voice pool.
+    Voice voices[MAX_VOICES];
+
+    /// @brief Stolen voices' sounds, fading out while their voices play new notes.
+    Voice fadingVoices[FADE_VOICES];
+
+    /// @brief The voice each source's key is playing on, so a note-off finds its voice without scanning the pool.
+    /// @details Voices end on their own without clearing their entry, so entries are checked by voiceForNote().
+    Voice *noteVoices[(int)NoteSource::COUNT][NUM_NOTES] = {};
+
+    /// @brief Whether the sustain pedal is down.
+    bool sustainDown = false;
+
+    /// @brief Counts releases, to order voices by when they were released.
+    uint64_t releaseCount = 0;
+
+    /// @brief The rate the synth renders at.
+    double sampleRate = DEFAULT_SAMPLE_RATE;
+
+    /// @brief The band-limited wavetables voices read from.
+    const WavetableBank &bank;
+
+    /// @brief Reads sampled voices between their frames.
+    const PolyphaseResampler &resampler;
+
+    /// @brief The kernel used to render voices, picked once at construction.
+    const RenderKernel &kernel;
+
+    /// @brief The piano strings the waveguide model plays. Always ringing, so a string is never started or stopped.
+    StringBank strings;
+
+    /// @brief Which of each source's keys currently hold a string's damper up.
+    bool stringHeld[(int)NoteSource::COUNT][NUM_NOTES] = {};
+
+    /// @brief The parameters, published by the setters for render() to pick up.
+    SnapshotStore<ParameterSnapshot> parameterSnapshots;
+
+    /// @brief The note tables, published by setTuning() for render() to pick up.
+    SnapshotStore<NoteTable> noteTables;
+
+    /// @brief The parameters and note table the current buffer is rendered with. Audio thread only.
+    const ParameterSnapshot *parameters = nullptr;
+    const NoteTable *noteTable = nullptr;
+
+    /// @brief The volume the last block ended at, so a change glides instead of stepping. Audio thread only.
+    float appliedVolume = DEFAULT_VOLUME;
+
+    /// @brief SAMPLE_ENVELOPE converted to per-sample steps.
+    EnvelopeCoefficients sampleEnvelope;
+
+    /// @brief The sample pack notes play from, or null.
+    const SamplePack *samplePack = nullptr;
+
+    /// @brief Streams the sample pack's data for sampled voices. Exists while a pack is set.
+    std::unique_ptr<SampleStreamer> streamer;
+
+    /// @brief For each zone root, the 32.32 fixed-point sample increment per Hz of the note played.
+    /// @details Includes the pack's sample rate, so starting a sampled note at any tuning needs no pow().
+    double zoneIncrementScales[NUM_NOTES];
+
+    /// @brief The master reverb, or null when none is set.
+    std::unique_ptr<PartitionedConvolver> reverb;
+
+    /// @brief The reverb's impulse response as it was given, kept to rebuild the reverb at a new rate.
+    std::vector<float> reverbResponse;
+    double reverbResponseRate = 0.0;
+
+    /// @brief Each note's pan and the stereo width, set from the input thread. panVersion is bumped after every change.
+    std::atomic<float> notePans[NUM_NOTES];
+    std::atomic<float> stereoWidth{DEFAULT_STEREO_WIDTH};
+    std::atomic<uint32_t> panVersion{1};
+
+    /// @brief The gains every note is mixed with, and the panVersion they were computed for. Audio thread only.
+    PanGains notePanGains[NUM_NOTES];
+    uint32_t appliedPanVersion = 0;
+
+    /// @brief The most a voice's gains may move in the block being rendered.
+    float panStep = 1.0f;
+
+    /// @brief Keeps the mixed bus under full scale.
+    LookaheadLimiter limiter;
+
+    /// @brief The song, and the frame each of its events falls on counted from the song's start.
+    const Sequence *sequence = nullptr;
+    std::vector<uint64_t> sequenceFrames;
+
+    /// @brief The song's next event, and how many frames of the song have been rendered. Audio thread only.
+    size_t sequenceCursor = 0;
+    uint64_t sequencePosition = 0;
+    bool sequenceRunning = false;
+
+    /// @brief What the song is doing, published by the audio thread for the UI.
+    std::atomic<bool> sequencePlaying{false};
+    std::atomic<uint64_t> sequenceNotes[NUM_NOTES / 64] = {};
+
+    /// @brief Helper threads for dense blocks, or null to render on the audio thread only.
+    std::unique_ptr<VoiceWorkerPool> workers;
+    static_assert(MAX_BLOCK_FRAMES <= VoiceWorkerPool::MAX_FRAMES, "render workers must fit a whole block");
+
+    /// @brief The voices sounding in the block being rendered, gathered before the block is split into groups.
+    Voice *activeVoices[MAX_VOICES + FADE_VOICES];
+    int activeVoiceCount = 0;
+
+    /// @brief The stereo bus the voices are summed into: the block's left samples, then its right samples.
+    alignas(32) float mix[2 * MAX_BLOCK_FRAMES];
+
+    /// @brief Scratch for one voice: its per-sample envelope gain, then its mono output.
+    alignas(32) float scratch[2 * MAX_BLOCK_FRAMES];
+
+    /// @brief The strings' output, then the reverb's, for the block being rendered.
+    alignas(32) float wet[MAX_BLOCK_FRAMES];
+};
+
+#endif //GRAPHICS_SYNTH_H
@@ -0,0 +1,286 @@
+#include "tuning.h"
+
+#include <cstdio>
+#include <math.h>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+/// @brief Each temperament's twelve pitches in cents above its tonic.
+constexpr double TEMPERAMENT_CENTS[(int)Temperament::COUNT][12] = {
+        {0.0, 100.0, 200.0, 300.0, 400.0, 500.0, 600.0, 700.0, 800.0, 900.0, 1000.0, 1100.0},
+        {0.0, 113.685, 203.910, 294.135, 407.820, 498.045, 611.730, 701.955, 815.640, 905.865, 996.090, 1109.775},
+        {0.0, 76.049, 193.157, 310.265, 386.314, 503.422, 579.471, 696.578, 772.627, 889.735, 1006.843, 1082.892},
+        {0.0, 90.225, 192.180, 294.135, 390.225, 498.045, 588.270, 696.090, 792.180, 888.270, 996.090, 1092.180},
+        {0.0, 90.225, 193.157, 294.135, 386.314, 498.045, 590.224, 696.578, 792.180, 889.735, 996.090, 1088.269},
+        {0.0, 94.135, 196.090, 298.045, 392.180, 501.955, 592.180, 698.045, 796.090, 894.135, 999.910, 1090.225},
+        {0.0, 111.731, 203.910, 315.641, 386.314, 498.045, 590.224, 701.955, 813.686, 884.359, 1017.596, 1088.269},
+};
+
+const char *const TEMPERAMENT_NAMES[(int)Temperament::COUNT] = {
+        "equal", "pythagorean", "meantone", "werckmeister3", "kirnberger3", "vallotti", "just",
+};
+
+/// @brief Division rounding towards negative infinity, so notes below the mapping's start land in lower octaves.
+int floorDivide(int a, int b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0) ? 1 : 0);
+}
+
+int floorModulo(int a, int b) {
+    return a - floorDivide(a, b) * b;
+}
+
+bool readFile(const std::string &path, std::string &text, std::string &error) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        error = "could not open " + path;
+        return false;
+    }
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, read);
+    }
+    fclose(file);
+    return true;
+}
+
+/// @brief The lines of a Scala file that are not comments, with surrounding whitespace removed.
+std::vector<std::string> scalaLines(const std::string &text) {
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line[0] == '!') {
+            continue;
+        }
+        size_t first = line.find_first_not_of(" \t\r");
+        size_t last = line.find_last_not_of(" \t\r");
+        lines.push_back(first == std::string::npos ? std::string() : line.substr(first, last - first + 1));
+    }
+    return lines;
+}
+
+/// @brief Parses a scale degree: cents if it has a period, otherwise a ratio like 3/2 or a whole number like 2.
+bool parsePitch(const std::string &line, double &cents) {
+    std::istringstream stream(line);
+    std::string token;
+    stream >> token;
+    if (token.empty()) {
+        return false;
+    }
+    if (token.find('.') != std::string::npos) {
+        char *end;
+        cents = strtod(token.c_str(), &end);
+        return *end == '\0';
+    }
+    long numerator = 0, denominator = 1;
+    char slash = 0;
+    char extra = 0;
+    int fields = sscanf(token.c_str(), "%ld%c%ld%c", &numerator, &slash, &denominator, &extra);
+    if (!(fields == 1 || (fields == 3 && slash == '/')) || numerator <= 0 || denominator <= 0) {
+        return false;
+    }
+    cents = 1200.0 * log2((double)numerator / denominator);
+    return true;
+}
+
+/// @brief Reads the next non-comment line of a .kbm as a number, or x for an unmapped key.
+bool nextMappingField(const std::vector<std::string> &lines, size_t &index, double &value, bool &unmapped) {
+    while (index < lines.size() && lines[index].empty()) {
+        index++;
+    }
+    if (index == lines.size()) {
+        return false;
+    }
+    std::istringstream stream(lines[index++]);
+    std::string token;
+    stream >> token;
+    unmapped = token == "x" || token == "X";
+    if (unmapped) {
+        return true;
+    }
+    char *end;
+    value = strtod(token.c_str(), &end);
+    return *end == '\0';
+}
+
+} // namespace
+
+Tuning::Tuning() {
+    temper(Temperament::Equal, DEFAULT_REFERENCE, 0);
+}
+
+Tuning Tuning::fromTemperament(Temperament temperament, double reference, int tonic) {
+    Tuning tuning;
+    tuning.temper(temperament, reference, tonic);
+    return tuning;
+}
+
+void Tuning::temper(Temperament temperament, double reference, int tonic) {
+    const double *cents = TEMPERAMENT_CENTS[(int)temperament];
+    tonic = floorModulo(tonic, 12);
+    auto centsOf = [&](int note) {
+        int offset = note - tonic;
+        return 1200.0 * floorDivide(offset, 12) + cents[floorModulo(offset, 12)];
+    };
+
+    double a4 = centsOf(69);
+    for (int note = 0; note < NUM_NOTES; note++) {
+        frequencies[note] = reference * exp2((centsOf(note) - a4) / 1200.0);
+    }
+    this->temperament = temperament;
+    fromScala = false;
+    name = TEMPERAMENT_NAMES[(int)temperament];
+    if (temperament != Temperament::Equal && tonic != 0) {
+        static const char *const PITCH_CLASSES[12] = {"C", "C#", "D", "Eb", "E", "F", "F#", "G", "G#", "A", "Bb", "B"};
+        name += std::string(" on ") + PITCH_CLASSES[tonic];
+    }
+    if (reference != DEFAULT_REFERENCE) {
+        std::ostringstream label;
+        label << ", A4 = " << reference << " Hz";
+        name += label.str();
+    }
+}
+
+bool Tuning::loadScala(const std::string &scalePath, const std::string &mappingPath, double reference,
+                       Tuning &tuning, std::string &error) {
+    std::string scale, mapping;
+    if (!readFile(scalePath, scale, error) || (!mappingPath.empty() && !readFile(mappingPath, mapping, error))) {
+        return false;
+    }
+    return parseScala(scale, mapping, reference, tuning, error);
+}
+
+bool Tuning::parseScala(const std::string &scale, const std::string &mapping, double reference, Tuning &tuning,
+                        std::string &error) {
+    // The scale: a description, the number of degrees, then each degree above the first. The last is the period.
+    std::vector<std::string> lines = scalaLines(scale);
+    if (lines.size() < 2) {
+        error = "scale has no description or degree count";
+        return false;
+    }
+    char *end;
+    long count = strtol(lines[1].c_str(), &end, 10);
+    if (end == lines[1].c_str() || count < 1 || (size_t)count > lines.size() - 2) {
+        error = "scale has a bad degree count";
+        return false;
+    }
+    std::vector<double> cents(1, 0.0);
+    for (long degree = 0; degree < count; degree++) {
+        double pitch;
+        if (!parsePitch(lines[2 + degree], pitch)) {
+            error = "bad scale degree '" + lines[2 + degree] + "'";
+            return false;
+        }
+        cents.push_back(pitch);
+    }
+    double period = cents.back();
+
+    // The mapping: its size, the first and last keys mapped, the key degree 0 is on, the reference key and
+    // its frequency, the degree that repeats the pattern, then each key's degree. Size 0 maps keys to degrees in order.
+    int mapSize = 0, firstNote = 0, lastNote = NUM_NOTES - 1, middleNote = 60, referenceNote = 60, octaveDegree = 0;
+    double referenceFrequency = reference * exp2(-9.0 / 12.0);
+    std::vector<int> keys;
+    if (!mapping.empty()) {
+        std::vector<std::string> mapLines = scalaLines(mapping);
+        size_t index = 0;
+        double fields[7];
+        bool unmapped;
+        for (double &field : fields) {
+            if (!nextMappingField(mapLines, index, field, unmapped) || unmapped) {
+                error = "keyboard mapping header is incomplete";
+                return false;
+            }
+        }
+        mapSize = (int)fields[0];
+        firstNote = (int)fields[1];
+        lastNote = (int)fields[2];
+        middleNote = (int)fields[3];
+        referenceNote = (int)fields[4];
+        referenceFrequency = fields[5];
+        octaveDegree = (int)fields[6];
+        if (mapSize < 0 || referenceFrequency <= 0.0) {
+            error = "keyboard mapping has a bad size or reference frequency";
+            return false;
+        }
+        for (int key = 0; key < mapSize; key++) {
+            double degree = 0.0;
+            // Keys the file leaves out at the end are unmapped
+            if (!nextMappingField(mapLines, index, degree, unmapped) || unmapped) {
+                keys.push_back(-1);
+            } else {
+                keys.push_back((int)degree);
+            }
+        }
+    }
+    if (octaveDegree <= 0) {
+        octaveDegree = mapSize > 0 ? mapSize : (int)count;
+    }
+
+    // A key's pitch in cents above degree 0, or false if it is unmapped
+    auto centsOf = [&](int note, double &pitch) {
+        int degree;
+        if (mapSize == 0) {
+            degree = note - middleNote;
+        } else {
+            int offset = note - middleNote;
+            int key = keys[floorModulo(offset, mapSize)];
+            if (key < 0) {
+                return false;
+            }
+            degree = floorDivide(offset, mapSize) * octaveDegree + key;
+        }
+        pitch = floorDivide(degree, (int)count) * period + cents[floorModulo(degree, (int)count)];
+        return true;
+    };
+
+    double referenceCents;
+    if (!centsOf(referenceNote, referenceCents)) {
+        error = "keyboard mapping leaves its reference key unmapped";
+        return false;
+    }
+    for (int note = 0; note < NUM_NOTES; note++) {
+        double pitch;
+        bool mapped = note >= firstNote && note <= lastNote && centsOf(note, pitch);
+        tuning.frequencies[note] = mapped ? referenceFrequency * exp2((pitch - referenceCents) / 1200.0) : 0.0;
+    }
+    tuning.name = lines[0].empty() ? "Scala scale" : lines[0];
+    tuning.fromScala = true;
+    return true;
+}
+
+const char *Tuning::temperamentName(Temperament temperament) {
+    return TEMPERAMENT_NAMES[(int)temperament];
+}
+
+bool Tuning::parseTemperament(const std::string &name, Temperament &temperament) {
+    for (int i = 0; i < (int)Temperament::COUNT; i++) {
+        if (name == TEMPERAMENT_NAMES[i]) {
+            temperament = (Temperament)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+double Tuning::getFrequency(int note) const {
+    return note >= 0 && note < NUM_NOTES ? frequencies[note] : 0.0;
+}
+
+const double *Tuning::getFrequencies() const {
+    return frequencies;
+}
+
+const std::string &Tuning::getName() const {
+    return name;
+}
+
+bool Tuning::getTemperament(Temperament &temperament) const {
+    if (fromScala) {
+        return false;
+    }
+    temperament = this->temperament;
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef GRAPHICS_TUNING_H
+#define GRAPHICS_TUNING_H
+
+#include <string>
+
+/// @brief Keyboard temperaments, each a fixed set of twelve pitches per octave.
+enum class Temperament {
+    Equal,                ///< Twelve equal semitones
+    Pythagorean,          ///< Pure fifths from Eb to G#, with the wolf between G# and Eb
+    QuarterCommaMeantone, ///< Pure major thirds, fifths narrowed by a quarter of the syntonic comma
+    Werckmeister3,        ///< Werckmeister III: four fifths narrowed by a quarter of the Pythagorean comma
+    Kirnberger3,          ///< Kirnberger III: pure C-E, the comma shared by the fifths between them
+    Vallotti,             ///< Six fifths from F to B narrowed by a sixth of the Pythagorean comma
+    Just,                 ///< Five-limit just intonation on the tonic
+    COUNT
+};
+
+/**
+ * @brief A frequency for every MIDI note.
+ * @details Built from a temperament and a reference pitch for A4, or from a Scala scale (.scl) with an optional
+ * keyboard mapping (.kbm). Building one takes a little math per note, so it is done off the audio thread;
+ * Synth::setTuning() turns it into the tables the audio thread reads.
+ */
+class Tuning {
+public:
+    /// @brief The number of MIDI notes.
+    static constexpr int NUM_NOTES = 128;
+
+    /// @brief The usual pitch of A4.
+    static constexpr double DEFAULT_REFERENCE = 440.0;
+
+    /// @brief Equal temperament with A4 at 440 Hz.
+    Tuning();
+
+    /// @brief A temperament, with its tonic on a pitch class and A4 tuned to a reference.
+    /// @param temperament The temperament
+    /// @param reference The frequency of A4 in Hz
+    /// @param tonic The pitch class the temperament is laid out from, 0 for C to 11 for B
+    static Tuning fromTemperament(Temperament temperament, double reference = DEFAULT_REFERENCE, int tonic = 0);
+
+    /// @brief Reads a Scala scale and, optionally, a keyboard mapping.
+    /// @param scalePath The .scl file
+    /// @param mappingPath The .kbm file, or empty to put degree 0 on middle C at its equal-tempered pitch for reference
+    /// @param reference The frequency of A4 the default mapping is worked out from. A .kbm sets its own.
+    /// @param tuning Receives the tuning
+    /// @param error Receives a description of the problem if a file could not be read
+    /// @return true if the tuning was read
+    static bool loadScala(const std::string &scalePath, const std::string &mappingPath, double reference,
+                          Tuning &tuning, std::string &error);
+
+    /// @brief Parses a Scala scale and keyboard mapping already in memory.
+    /// @see loadScala()
+    static bool parseScala(const std::string &scale, const std::string &mapping, double reference, Tuning &tuning,
+                           std::string &error);
+
+    /// @brief "equal", "pythagorean", "meantone", "werckmeister3", "kirnberger3", "vallotti" or "just".
+    static const char *temperamentName(Temperament temperament);
+
+    /// @brief Parses a temperament name as printed by temperamentName().
+    /// @return false if the name is not a temperament
+    static bool parseTemperament(const std::string &name, Temperament &temperament);
+
+    /// @brief A note's frequency in Hz, or 0 if the keyboard mapping leaves it unmapped.
+    double getFrequency(int note) const;
+
+    /// @brief Every note's frequency, NUM_NOTES values.
+    const double *getFrequencies() const;
+
+    /// @brief What the tuning is, for log messages.
+    const std::string &getName() const;
+
+    /// @brief The temperament the tuning was built from.
+    /// @return false if it was read from a Scala scale instead
+    bool getTemperament(Temperament &temperament) const;
+
+private:
+    /// @brief Lays a temperament out across the keyboard, see fromTemperament().
+    void temper(Temperament temperament, double reference, int tonic);
+
+    double frequencies[NUM_NOTES];
+    std::string name;
+
+    /// @brief What temper() last laid out, unless a Scala scale has been parsed over it since.
+    Temperament temperament = Temperament::Equal;
+    bool fromScala = false;
+};
+
+#endif //GRAPHICS_TUNING_H
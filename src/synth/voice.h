@@ -0,0 +1,70 @@
+#ifndef GRAPHICS_VOICE_H
+#define GRAPHICS_VOICE_H
+
+#include <cstdint>
+
+#include "envelope.h"
+#include "mixer.h"
+#include "samplePack.h"
+
+/// @brief Who started a note: the player's keys or the song the synth plays.
+/// @details Each keeps its own key state, so neither releases a note the other is holding.
+enum class NoteSource : uint8_t {
+    Player,
+    Sequence,
+    COUNT
+};
+
+/// @brief A single oscillator slot in the synth's voice pool.
+/// @details Voices are preallocated and never created or destroyed while the stream runs.
+/// They are only touched by the audio callback, which claims them on note-on and frees
+/// them once their envelope has faded out after note-off.
+struct Voice {
+    /// @brief The MIDI note this voice is playing, or -1 if the voice is free.
+    /// @details Stays set while the envelope is releasing.
+    int note = -1;
+
+    /// @brief Whose key started the note, and so whose note-off releases it.
+    NoteSource source = NoteSource::Player;
+
+    /// @brief Position in the waveform's cycle as a 32-bit fixed-point fraction.
+    /// @details A full cycle is 2^32, so the phase wraps on its own when it overflows.
+    uint32_t phase = 0;
+
+    /// @brief How far the phase advances per sample, in the same units as phase.
+    uint32_t increment = 0;
+
+    /// @brief The band-limited wavetable picked for this voice's pitch when the note started.
+    const float *table = nullptr;
+
+    /// @brief The recorded sample this voice plays, or null if it plays the wavetable.
+    const SampleZone *zone = nullptr;
+
+    /// @brief The SampleStreamer stream feeding the sample past its head, or -1 if the voice only has the head.
+    int stream = -1;
+
+    /// @brief Position in the sample as a 32.32 fixed-point frame number.
+    uint64_t samplePosition = 0;
+
+    /// @brief How far samplePosition advances per output sample, in the same units.
+    uint64_t sampleIncrement = 0;
+
+    /// @brief The voice's amplitude envelope.
+    Envelope envelope;
+
+    /// @brief The gains the voice was last mixed into each channel with. Ramped towards its note's pan block by block.
+    PanGains pan;
+
+    /// @brief True if the key is up but the sustain pedal is holding the note.
+    bool sustained = false;
+
+    /// @brief When the voice started releasing, counted in releases, so the oldest release can be stolen first.
+    uint64_t releaseOrder = 0;
+
+    /// @brief True if the note has not been released. Includes notes the sustain pedal is holding.
+    bool isHeld() const {
+        return note != -1 && envelope.getStage() != Envelope::Release && envelope.getStage() != Envelope::Fade;
+    }
+};
+
+#endif //GRAPHICS_VOICE_H
@@ -0,0 +1,163 @@
+#include "voiceWorkerPool.h"
+
+#include <chrono>
+
+#include "denormals.h"
+#include "realtimeGuard.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// @brief How long workers keep spinning after the last job before they start sleeping between checks.
+constexpr auto SPIN_TIMEOUT = std::chrono::milliseconds(100);
+
+/// @brief How long an idle worker sleeps between checks for work.
+constexpr auto IDLE_SLEEP = std::chrono::milliseconds(1);
+
+constexpr uint64_t ITEM_MASK = 0xffff;
+
+/// @brief Tells the CPU this is a spin-wait loop.
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/// @brief Pins a worker to its own core and, if real-time priority was asked for, runs it one step below the audio thread.
+/// @details Without cores to use, core 0 is left to the audio and UI threads. Without a priority, or at priority 1
+/// where there is no step below, the worker keeps normal scheduling. Both requests are best effort: without the
+/// privileges for SCHED_FIFO the worker keeps normal priority and still helps.
+ThreadPlacement makeRealtime(std::thread &thread, int index, const RealtimeOptions &options) {
+    int core = options.coreFor(1 + index);
+    unsigned cores = std::thread::hardware_concurrency();
+    if (options.cores.empty() && cores > 1) {
+        core = 1 + index % (cores - 1);
+    }
+    int priority = options.priority > 1 ? options.priority - 1 : 0;
+    return placeThread(thread, priority, core);
+}
+
+} // namespace
+
+VoiceWorkerPool::VoiceWorkerPool(int workers, const RealtimeOptions &options)
+        : workerCount(workers < 0 ? 0 : (workers > MAX_WORKERS ? MAX_WORKERS : workers)) {
+    for (int i = 0; i < workerCount; i++) {
+        this->workers[i].thread = std::thread(&VoiceWorkerPool::run, this, std::ref(this->workers[i]));
+        this->workers[i].placement = makeRealtime(this->workers[i].thread, i, options);
+    }
+}
+
+VoiceWorkerPool::~VoiceWorkerPool() {
+    running.store(false, std::memory_order_relaxed);
+    for (int i = 0; i < workerCount; i++) {
+        workers[i].thread.join();
+    }
+}
+
+int VoiceWorkerPool::getWorkerCount() const {
+    return workerCount;
+}
+
+const ThreadPlacement &VoiceWorkerPool::getPlacement(int worker) const {
+    return workers[worker].placement;
+}
+
+void VoiceWorkerPool::render(RenderItemFunction renderItem, void *context, int itemCount, float *mix, float *scratch,
+                             unsigned long frames) {
+    uint32_t job = ++lastGeneration;
+    if (job == 0) {
+        // Generation 0 means "no job yet" to the workers
+        job = ++lastGeneration;
+    }
+
+    jobFunction = renderItem;
+    jobContext = context;
+    jobFrames = frames;
+    completed.store(0, std::memory_order_relaxed);
+    next.store(((uint64_t)job << 32) | ((uint64_t)itemCount << 16), std::memory_order_release);
+    generation.store(job, std::memory_order_release);
+
+    // Help out, then wait for the items the workers claimed
+    renderItems(job, mix, scratch, nullptr);
+    while (completed.load(std::memory_order_acquire) < itemCount) {
+        cpuRelax();
+    }
+
+    for (int i = 0; i < workerCount; i++) {
+        if (workers[i].usedGeneration.load(std::memory_order_relaxed) != job) {
+            continue;
+        }
+        const float *partial = workers[i].mix;
+        for (unsigned long frame = 0; frame < 2 * frames; frame++) {
+            mix[frame] += partial[frame];
+        }
+    }
+}
+
+bool VoiceWorkerPool::claim(uint32_t job, int &item) {
+    uint64_t current = next.load(std::memory_order_acquire);
+    while (true) {
+        if ((uint32_t)(current >> 32) != job) {
+            return false;
+        }
+        uint64_t index = current & ITEM_MASK;
+        uint64_t count = (current >> 16) & ITEM_MASK;
+        if (index >= count) {
+            return false;
+        }
+        if (next.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            item = (int)index;
+            return true;
+        }
+    }
+}
+
+int VoiceWorkerPool::renderItems(uint32_t job, float *mix, float *scratch, Worker *worker) {
+    int rendered = 0;
+    int item;
+    while (claim(job, item)) {
+        if (worker != nullptr && rendered == 0) {
+            // First item of this job: start from silence and tell the caller to sum this buffer
+            for (unsigned long frame = 0; frame < 2 * jobFrames; frame++) {
+                mix[frame] = 0.0f;
+            }
+            worker->usedGeneration.store(job, std::memory_order_relaxed);
+        }
+        jobFunction(jobContext, item, mix, scratch, jobFrames);
+        rendered++;
+        completed.fetch_add(1, std::memory_order_release);
+    }
+    return rendered;
+}
+
+void VoiceWorkerPool::run(Worker &worker) {
+    ScopedFlushToZero flushToZero;
+    ScopedRealtimeThread realtime;
+    uint32_t seen = 0;
+    Clock::time_point lastJob = Clock::now();
+    int spins = 0;
+
+    while (running.load(std::memory_order_relaxed)) {
+        uint32_t job = generation.load(std::memory_order_acquire);
+        if (job != seen) {
+            seen = job;
+            spins = 0;
+            renderItems(job, worker.mix, worker.scratch, &worker);
+            lastJob = Clock::now();
+            continue;
+        }
+
+        // Spin while the audio thread keeps handing out work, then back off so a quiet synth costs no CPU
+        cpuRelax();
+        if (++spins % 1024 == 0 && Clock::now() - lastJob > SPIN_TIMEOUT) {
+            std::this_thread::sleep_for(IDLE_SLEEP);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef GRAPHICS_VOICEWORKERPOOL_H
+#define GRAPHICS_VOICEWORKERPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "realtimeThread.h"
+
+/**
+ * @brief Spinning helper threads that render a block's voices alongside the audio thread.
+ * @details render() forks a job of numbered items (groups of voices) and joins once every item is done.
+ * The calling thread and the workers claim items one at a time from a shared counter, so a worker that
+ * finishes a light group moves straight on to the next one instead of the slowest group setting the
+ * pace. Each thread sums into its own buffer, and the caller adds the buffers together after the join.
+ *
+ * There are no locks and nothing is allocated once the pool exists. The join only waits for items that
+ * have been claimed, so a worker the OS has not scheduled in time just sits the job out.
+ * Workers spin while jobs keep coming and back off to short sleeps once the synth goes quiet.
+ */
+class VoiceWorkerPool {
+public:
+    /// @brief The most helper threads a pool runs.
+    static constexpr int MAX_WORKERS = 8;
+
+    /// @brief The longest block a job may render.
+    static constexpr unsigned long MAX_FRAMES = 256;
+
+    /// @brief Renders one item of a job, summing it into mix.
+    /// @param context The context passed to render()
+    /// @param item The item to render, from 0 to the job's item count
+    /// @param mix The planar stereo buffer of the thread rendering the item: frames left samples, then frames right samples
+    /// @param scratch Scratch space of 2 * MAX_FRAMES floats owned by the thread rendering the item
+    /// @param frames The number of frames to render
+    typedef void (*RenderItemFunction)(void *context, int item, float *mix, float *scratch, unsigned long frames);
+
+    /// @brief Starts the worker threads, pinned to their own cores and raised to real-time priority if options ask for it,
+    /// where the OS allows it.
+    /// @param workers The number of helper threads, at most MAX_WORKERS
+    /// @param options The audio thread's priority, which the workers run one step below, and the cores to pin
+    /// them to from options.cores[1] on
+    explicit VoiceWorkerPool(int workers, const RealtimeOptions &options = RealtimeOptions());
+
+    /// @brief Stops and joins the worker threads.
+    ~VoiceWorkerPool();
+
+    VoiceWorkerPool(const VoiceWorkerPool &) = delete;
+    VoiceWorkerPool &operator=(const VoiceWorkerPool &) = delete;
+
+    /// @brief The number of helper threads.
+    int getWorkerCount() const;
+
+    /// @brief How a helper thread was placed when it started.
+    const ThreadPlacement &getPlacement(int worker) const;
+
+    /// @brief Renders items 0 to itemCount - 1 across the calling thread and the workers, summed into mix.
+    /// @details Only one thread may call render(), and it renders items itself while it waits.
+    /// @param renderItem Called once per item
+    /// @param context Passed to renderItem
+    /// @param itemCount The number of items in the job, below 65536
+    /// @param mix The caller's planar stereo buffer, which items are added to
+    /// @param scratch The caller's scratch space of 2 * MAX_FRAMES floats
+    /// @param frames The number of frames to render, at most MAX_FRAMES
+    void render(RenderItemFunction renderItem, void *context, int itemCount, float *mix, float *scratch,
+                unsigned long frames);
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    /// @brief One helper thread and the buffers it renders into.
+    struct alignas(CACHE_LINE) Worker {
+        std::thread thread;
+        ThreadPlacement placement;
+        /// @brief The last job this worker rendered any items of. Its mix only holds that job's output.
+        std::atomic<uint32_t> usedGeneration{0};
+        alignas(CACHE_LINE) float mix[2 * MAX_FRAMES];
+        float scratch[2 * MAX_FRAMES];
+    };
+
+    /// @brief A worker thread's loop.
+    void run(Worker &worker);
+
+    /// @brief Claims the next unrendered item of a job.
+    /// @return false if the job has moved on or every item has been claimed
+    bool claim(uint32_t generation, int &item);
+
+    /// @brief Renders items of a job until none are left.
+    /// @return the number of items rendered
+    int renderItems(uint32_t generation, float *mix, float *scratch, Worker *worker);
+
+    Worker workers[MAX_WORKERS];
+    int workerCount;
+    std::atomic<bool> running{true};
+
+    /// @brief Bumped by render() to hand a new job to the workers.
+    alignas(CACHE_LINE) std::atomic<uint32_t> generation{0};
+
+    /// @brief The job's generation in the high 32 bits, its item count in the next 16 and the next unclaimed item in the low 16.
+    /// @details Packing them lets a single compare-and-swap check that an item belongs to the job a worker woke up for.
+    alignas(CACHE_LINE) std::atomic<uint64_t> next{0};
+
+    /// @brief The number of items of the current job that have finished rendering.
+    alignas(CACHE_LINE) std::atomic<int> completed{0};
+
+    // The current job. Written by render() before it publishes the generation, and only read
+    // after claiming an item of that generation, which cannot happen once the job is over.
+    alignas(CACHE_LINE) RenderItemFunction jobFunction = nullptr;
+    void *jobContext = nullptr;
+    unsigned long jobFrames = 0;
+
+    /// @brief The generation of the last job render() started. Only used by the calling thread.
+    uint32_t lastGeneration = 0;
+};
+
+#endif //GRAPHICS_VOICEWORKERPOOL_H
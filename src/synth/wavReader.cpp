@@ -0,0 +1,114 @@
+#include "wavReader.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+uint32_t readLittleEndian(const unsigned char *data, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint32_t)data[i] << (8 * i);
+    }
+    return value;
+}
+
+/// @brief Converts one sample of any supported encoding to a float in [-1, 1].
+float decodeSample(const unsigned char *data, int bitsPerSample, bool isFloat) {
+    if (isFloat) {
+        uint32_t bits = readLittleEndian(data, 4);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    switch (bitsPerSample) {
+        case 16:
+            return (int16_t)readLittleEndian(data, 2) / 32768.0f;
+        case 24: {
+            // Sign-extend from the top of a 32-bit word
+            int32_t value = (int32_t)(readLittleEndian(data, 3) << 8) >> 8;
+            return value / 8388608.0f;
+        }
+        default:
+            return (int32_t)readLittleEndian(data, 4) / 2147483648.0f;
+    }
+}
+
+} // namespace
+
+bool WavReader::loadMono(const std::string &path, std::vector<float> &samples, int &sampleRate, std::string &error) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        error = "could not open " + path;
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char buffer[65536];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + count);
+    }
+    fclose(file);
+
+    if (bytes.size() < 12 || memcmp(bytes.data(), "RIFF", 4) != 0 || memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        error = "not a WAV file";
+        return false;
+    }
+
+    int channels = 0, bitsPerSample = 0;
+    bool isFloat = false;
+    const unsigned char *data = nullptr;
+    size_t dataBytes = 0;
+
+    // Walk the chunks; anything other than fmt and data is skipped
+    size_t position = 12;
+    while (position + 8 <= bytes.size()) {
+        const unsigned char *chunk = bytes.data() + position;
+        size_t size = readLittleEndian(chunk + 4, 4);
+        size_t available = bytes.size() - position - 8;
+        if (size > available) {
+            size = available;
+        }
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            int format = (int)readLittleEndian(chunk + 8, 2);
+            channels = (int)readLittleEndian(chunk + 10, 2);
+            sampleRate = (int)readLittleEndian(chunk + 12, 4);
+            bitsPerSample = (int)readLittleEndian(chunk + 22, 2);
+            // WAVE_FORMAT_EXTENSIBLE keeps the real format at the start of the sub-format GUID
+            if (format == 0xFFFE && size >= 26) {
+                format = (int)readLittleEndian(chunk + 32, 2);
+            }
+            isFloat = format == 3;
+            if (format != 1 && format != 3) {
+                error = "unsupported WAV encoding " + std::to_string(format);
+                return false;
+            }
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            dataBytes = size;
+        }
+        position += 8 + size + (size & 1);
+    }
+
+    if (data == nullptr || channels <= 0) {
+        error = "WAV file has no fmt or data chunk";
+        return false;
+    }
+    if (!(bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32) || (isFloat && bitsPerSample != 32)) {
+        error = "unsupported WAV sample size " + std::to_string(bitsPerSample);
+        return false;
+    }
+
+    int bytesPerSample = bitsPerSample / 8;
+    size_t frames = dataBytes / (bytesPerSample * channels);
+    samples.resize(frames);
+    for (size_t frame = 0; frame < frames; frame++) {
+        float sum = 0.0f;
+        for (int channel = 0; channel < channels; channel++) {
+            sum += decodeSample(data + (frame * channels + channel) * bytesPerSample, bitsPerSample, isFloat);
+        }
+        samples[frame] = sum / channels;
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef GRAPHICS_WAVREADER_H
+#define GRAPHICS_WAVREADER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads WAV files into memory as float samples.
+ * @details Handles 16, 24 and 32-bit PCM and 32-bit float, with any number of channels.
+ */
+class WavReader {
+public:
+    /// @brief Reads a whole file, mixed down to mono.
+    /// @param path The file to read
+    /// @param samples Receives one sample per frame, averaged over the channels
+    /// @param sampleRate Receives the file's sample rate
+    /// @param error Receives a description of the problem if the file could not be read
+    /// @return true if the file was read
+    static bool loadMono(const std::string &path, std::vector<float> &samples, int &sampleRate, std::string &error);
+};
+
+#endif //GRAPHICS_WAVREADER_H
@@ -0,0 +1,91 @@
+#include "wavWriter.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+
+void putLittleEndian(unsigned char *out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+/// @brief The canonical 44-byte RIFF/WAVE header for 16-bit PCM.
+void makeHeader(unsigned char *header, int sampleRate, int channels, uint32_t dataBytes) {
+    const int bytesPerSample = 2;
+    memcpy(header, "RIFF", 4);
+    putLittleEndian(header + 4, 36 + dataBytes, 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    putLittleEndian(header + 16, 16, 4);                                    // fmt chunk size
+    putLittleEndian(header + 20, 1, 2);                                     // PCM
+    putLittleEndian(header + 22, channels, 2);
+    putLittleEndian(header + 24, sampleRate, 4);
+    putLittleEndian(header + 28, sampleRate * channels * bytesPerSample, 4); // byte rate
+    putLittleEndian(header + 32, channels * bytesPerSample, 2);              // block align
+    putLittleEndian(header + 34, 8 * bytesPerSample, 2);                     // bits per sample
+    memcpy(header + 36, "data", 4);
+    putLittleEndian(header + 40, dataBytes, 4);
+}
+
+} // namespace
+
+WavWriter::~WavWriter() {
+    close();
+}
+
+bool WavWriter::open(const std::string &path, int sampleRate, int channels) {
+    close();
+
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    this->sampleRate = sampleRate;
+    this->channels = channels;
+    framesWritten = 0;
+    // A fresh dither sequence per file, so rendering the same audio twice writes the same bytes
+    converter = SampleConverter(SampleFormat::Int16);
+
+    unsigned char header[44];
+    makeHeader(header, sampleRate, channels, 0);
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+bool WavWriter::write(const float *samples, unsigned long frames) {
+    if (file == nullptr) {
+        return false;
+    }
+
+    int16_t buffer[2048];
+    unsigned long count = frames * channels;
+    while (count > 0) {
+        unsigned long block = count < 2048 ? count : 2048;
+        // Little-endian 16-bit samples, which is what the host writes too
+        converter.convert(samples, buffer, block);
+        if (fwrite(buffer, sizeof(int16_t), block, file) != block) {
+            return false;
+        }
+        samples += block;
+        count -= block;
+    }
+    framesWritten += frames;
+    return true;
+}
+
+bool WavWriter::close() {
+    if (file == nullptr) {
+        return false;
+    }
+
+    unsigned char header[44];
+    makeHeader(header, sampleRate, channels, (uint32_t)(framesWritten * channels * 2));
+    bool ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+unsigned long WavWriter::getFramesWritten() const {
+    return framesWritten;
+}
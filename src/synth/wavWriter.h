@@ -0,0 +1,52 @@
+#ifndef GRAPHICS_WAVWRITER_H
+#define GRAPHICS_WAVWRITER_H
+
+#include <stdio.h>
+#include <string>
+
+#include "../audio/sampleConverter.h"
+
+/**
+ * @brief Writes interleaved float audio to a 16-bit PCM WAV file.
+ * @details The header is written with placeholder sizes on open() and patched on close(). Samples are rounded
+ * and dithered by the same SampleConverter a live Int16 stream uses, so a recording matches what was heard.
+ */
+class WavWriter {
+public:
+    WavWriter() = default;
+
+    /// @brief Destroy the WavWriter object, closing the file if it is still open
+    ~WavWriter();
+
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    /// @brief Creates the file and writes the header.
+    /// @param path The file to write
+    /// @param sampleRate The sample rate stored in the header
+    /// @param channels The number of interleaved channels
+    /// @return true if the file was created
+    bool open(const std::string &path, int sampleRate, int channels);
+
+    /// @brief Converts samples to dithered 16-bit and appends them. Samples outside [-1, 1] are clipped.
+    /// @param samples Interleaved samples, frames * channels of them
+    /// @param frames The number of frames to write
+    /// @return true if every sample was written
+    bool write(const float *samples, unsigned long frames);
+
+    /// @brief Patches the header sizes and closes the file.
+    /// @return true if the file was open and was finished cleanly
+    bool close();
+
+    /// @brief The number of frames written so far.
+    unsigned long getFramesWritten() const;
+
+private:
+    FILE *file = nullptr;
+    int sampleRate = 0;
+    int channels = 0;
+    unsigned long framesWritten = 0;
+    SampleConverter converter{SampleFormat::Int16};
+};
+
+#endif //GRAPHICS_WAVWRITER_H
@@ -0,0 +1,92 @@
+#include "wavetable.h"
+#include "sineTable.h"
+
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI  (3.14159265358979323846)
+#endif
+
+namespace {
+
+/// @brief Samples in one stored table, including the guard entry.
+constexpr int TABLE_STRIDE = WAVETABLE_SIZE + 1;
+
+/// @brief Where the hammer strikes along the string. Harmonics with a node there are not excited.
+constexpr double HAMMER_POSITION = 1.0 / 7.0;
+
+} // namespace
+
+WavetableBank::WavetableBank() : tables((size_t)Waveform::COUNT * NUM_LEVELS * TABLE_STRIDE) {
+    for (int w = 0; w < (int)Waveform::COUNT; w++) {
+        for (int level = 0; level < NUM_LEVELS; level++) {
+            float *table = &tables[((size_t)w * NUM_LEVELS + level) * TABLE_STRIDE];
+            buildTable((Waveform)w, harmonicsForLevel(level), table);
+        }
+    }
+}
+
+const WavetableBank &WavetableBank::shared() {
+    static const WavetableBank bank;
+    return bank;
+}
+
+const float *WavetableBank::getTable(Waveform waveform, int level) const {
+    return &tables[((size_t)waveform * NUM_LEVELS + level) * TABLE_STRIDE];
+}
+
+int WavetableBank::levelForIncrement(uint32_t increment) {
+    // The highest harmonic runs at increment * harmonics and must stay below half a cycle per sample
+    for (int level = 0; level < NUM_LEVELS - 1; level++) {
+        if ((uint64_t)increment * harmonicsForLevel(level) < (1ull << 31)) {
+            return level;
+        }
+    }
+    return NUM_LEVELS - 1;
+}
+
+int WavetableBank::harmonicsForLevel(int level) {
+    // 512 harmonics at level 0, halving every octave down to a pure sine
+    return (WAVETABLE_SIZE / 4) >> level;
+}
+
+double WavetableBank::harmonicAmplitude(Waveform waveform, int harmonic) {
+    switch (waveform) {
+        case Waveform::Sine:
+            return harmonic == 1 ? 1.0 : 0.0;
+        case Waveform::Saw:
+            return 1.0 / harmonic;
+        case Waveform::Square:
+            return (harmonic % 2 == 1) ? 1.0 / harmonic : 0.0;
+        case Waveform::Piano:
+            // Hammer strike position shapes the spectrum, stiffness rolls off the upper partials
+            return fabs(sin(M_PI * harmonic * HAMMER_POSITION)) / pow((double)harmonic, 1.5);
+        default:
+            return 0.0;
+    }
+}
+
+void WavetableBank::buildTable(Waveform waveform, int harmonics, float *table) {
+    std::vector<double> sum(WAVETABLE_SIZE, 0.0);
+    for (int h = 1; h <= harmonics; h++) {
+        double amplitude = harmonicAmplitude(waveform, h);
+        if (amplitude == 0.0) {
+            continue;
+        }
+        for (int i = 0; i < WAVETABLE_SIZE; i++) {
+            // Harmonic h at sample i is the base cycle at (h * i) mod size, so no sin() calls are needed
+            sum[i] += amplitude * SINE_CYCLE[((size_t)h * i) & (WAVETABLE_SIZE - 1)];
+        }
+    }
+
+    double peak = 0.0;
+    for (double s : sum) {
+        peak = fmax(peak, fabs(s));
+    }
+    double scale = peak > 0.0 ? 1.0 / peak : 0.0;
+
+    for (int i = 0; i < WAVETABLE_SIZE; i++) {
+        table[i] = (float)(sum[i] * scale);
+    }
+    table[WAVETABLE_SIZE] = table[0];
+}
@@ -0,0 +1,61 @@
+#ifndef GRAPHICS_WAVETABLE_H
+#define GRAPHICS_WAVETABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "renderKernel.h"
+
+/// @brief The waveforms a WavetableBank holds.
+enum class Waveform {
+    Sine,
+    Saw,
+    Square,
+    Piano, // additive timbre with piano-like harmonic falloff
+    COUNT
+};
+
+/**
+ * @brief Band-limited wavetables for every waveform, one mip level per octave.
+ * @details Level 0 holds the most harmonics and is used for the lowest notes. Each level up
+ * holds half as many harmonics as the one below, so a voice reading the level picked by
+ * levelForIncrement() never produces partials above Nyquist.
+ *
+ * The bank is built once and is read-only afterwards, so any number of synths and threads
+ * can share it.
+ */
+class WavetableBank {
+public:
+    /// @brief The number of mip levels per waveform. The top level is a pure sine.
+    static constexpr int NUM_LEVELS = 10;
+
+    /// @brief Construct a new WavetableBank object and build every table.
+    /// @details Sums partials with integer lookups into the compile-time SINE_CYCLE, so this takes a few milliseconds.
+    WavetableBank();
+
+    /// @brief A process-wide bank, built the first time it is asked for.
+    static const WavetableBank &shared();
+
+    /// @brief Returns one mip level of a waveform.
+    /// @return WAVETABLE_SIZE + 1 samples, the last equal to the first
+    const float *getTable(Waveform waveform, int level) const;
+
+    /// @brief Picks the lowest mip level that stays band-limited for a phase increment.
+    /// @param increment The voice's 32-bit fixed-point phase increment
+    static int levelForIncrement(uint32_t increment);
+
+    /// @brief The number of harmonics stored in a mip level.
+    static int harmonicsForLevel(int level);
+
+private:
+    /// @brief Adds harmonics 1..harmonics with the waveform's amplitudes into table, then normalizes it to a peak of 1.
+    void buildTable(Waveform waveform, int harmonics, float *table);
+
+    /// @brief The amplitude of a harmonic in a waveform's spectrum.
+    static double harmonicAmplitude(Waveform waveform, int harmonic);
+
+    /// @brief Every table back to back, indexed by waveform then level.
+    std::vector<float> tables;
+};
+
+#endif //GRAPHICS_WAVETABLE_H